@@ -0,0 +1,90 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "helpers/print.hpp"
+#include "kernel/radial.hpp"
+#include "math/approx.hpp"
+
+// nanoseconds per element of fn over the input
+template <class Fn>
+auto measure(std::size_t n, std::size_t rounds, Fn fn) {
+  const auto beg = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < rounds; ++r) {
+    fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto ns = std::chrono::duration<double, std::nano>(
+      end - beg);
+  return ns.count() / double(n * rounds);
+}
+
+int main() {
+  namespace approx = b2o::math::approx;
+  constexpr auto n = std::size_t{1} << 16;
+  constexpr auto rounds = std::size_t{200};
+  auto rng = std::mt19937_64{};
+  auto dist = std::uniform_real_distribution{-10.0, 10.0};
+  auto x = std::vector<double>(n);
+  auto y = std::vector<double>(n);
+  for (auto& xi : x) {
+    xi = dist(rng);
+  }
+  auto sink = 0.0;
+  const auto run = [&](auto name, auto fn) {
+    const auto ns = measure(n, rounds, [&] {
+      fn();
+      sink += y[n / 2];
+    });
+    b2o::print_number(name, ns);
+  };
+
+  // element-wise kernels (ns / element)
+  run("std::exp", [&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] = std::exp(x[i]);
+    }
+  });
+  run("approx::exp", [&] {
+    approx::exp(x.data(), y.data(), n);
+  });
+  run("std::erf", [&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] = std::erf(x[i]);
+    }
+  });
+  run("approx::erf", [&] {
+    approx::erf(x.data(), y.data(), n);
+  });
+  run("std cdf", [&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] = 0.5 * std::erfc(-x[i] / std::sqrt(2.0));
+    }
+  });
+  run("approx::cdf", [&] {
+    approx::cdf(x.data(), y.data(), n);
+  });
+
+  // radial kernel evaluations (ns / pair)
+  auto points = std::vector<std::array<double, 4>>(n);
+  for (auto& p : points) {
+    for (auto& pi : p) {
+      pi = dist(rng);
+    }
+  }
+  const auto kernel = [&](auto name, const auto& k) {
+    run(name, [&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        y[i] = k(points[i], points[n - 1 - i]);
+      }
+    });
+  };
+  kernel("radial<standard>", b2o::kernel::radial{2.0});
+  kernel(
+      "radial<fast>",
+      b2o::kernel::radial<double, b2o::math::fast>{2.0});
+
+  b2o::print_number("checksum", sink);
+}
@@ -0,0 +1,68 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gaussian/process.hpp"
+#include "helpers/print.hpp"
+#include "helpers/thread_pool.hpp"
+#include "kernel/radial.hpp"
+#include "solver/direct.hpp"
+#include "solver/tiled_cholesky.hpp"
+
+// milliseconds per call of fn
+template <class Fn>
+auto measure(std::size_t rounds, Fn fn) {
+  const auto beg = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < rounds; ++r) {
+    fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto ms = std::chrono::duration<double, std::milli>(
+      end - beg);
+  return ms.count() / double(rounds);
+}
+
+int main() {
+  using input_t = std::array<double, 4>;
+  using factor_t = b2o::math::tiled_cholesky<double>;
+  using solver_t = b2o::math::direct<double, factor_t>;
+  using kernel_t = b2o::kernel::radial<double>;
+  using process_t =
+      b2o::gaussian::process<kernel_t, double, 4, solver_t>;
+  constexpr auto n = std::size_t{2048};
+  constexpr auto rounds = std::size_t{5};
+  auto rng = std::mt19937_64{};
+  auto dist = std::uniform_real_distribution{-1.0, 1.0};
+  auto samples = std::vector<std::pair<input_t, double>>(n);
+  for (auto& [x, y] : samples) {
+    for (auto& xi : x) {
+      xi = dist(rng);
+    }
+    y = dist(rng);
+  }
+
+  // full kernel, tiled factorization and solve of n
+  // samples (ms / fit) against the worker threads
+  const auto cores = std::thread::hardware_concurrency();
+  auto sink = 0.0;
+  for (auto threads = 1u; threads <= cores; threads *= 2) {
+    auto pool = b2o::thread_pool{threads};
+    const auto ms = measure(rounds, [&] {
+      const auto model = process_t{
+          kernel_t{1.0},
+          samples,
+          1e-2,
+          solver_t{factor_t{pool}}};
+      sink += std::get<0>(model.predict(samples[0].first));
+    });
+    const auto name = std::to_string(threads) + " threads";
+    b2o::print_number("solve_full " + name, ms);
+  }
+
+  b2o::print_number("checksum", sink);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "dual/operations/sqrt.hpp"
 #include "dual/operations/log.hpp"
 #include "gaussian/distribution.hpp"
@@ -22,6 +24,25 @@ class expected_improvement {
   template <class Input>
   auto operator()(const Input& x) const {
     const auto [mu, var] = model_.predict(x);
+    return evaluate(mu, var);
+  }
+
+  // Value only, over a batch (screening)
+  template <class Input>
+  auto score(const std::vector<Input>& x) const
+      -> std::vector<Number> {
+    auto result = std::vector<Number>{};
+    result.reserve(x.size());
+    for (const auto& [mu, var] : model_.predict(x)) {
+      result.emplace_back(evaluate(mu, var));
+    }
+    return result;
+  }
+
+ protected:
+  template <class NumberLike>
+  auto evaluate(const NumberLike& mu, const NumberLike& var)
+      const {
     const auto sigma = std::sqrt(var + kJitter);
     const auto delta = best_ - mu;
     const auto z = delta / sigma;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "acquisition/expected_improvement.hpp"
+#include "gaussian/classifier.hpp"
+
+namespace b2o::acquisition {
+
+// @brief Expected improvement weighted by feasibility
+//
+//   a(x) = log EI(x) + log p(x) = log(EI(x) p(x)) ,
+//
+// where p is the probability of feasibility of a
+// classifier fitted on the evaluated inputs (objectives
+// returning std::nullopt, or NaN, where they fail). The
+// best value is over the feasible samples; before the
+// first one, EI is flat and the search only avoids the
+// failures.
+//
+template <class Model, class Number>
+class expected_improvement_feasible
+    : public expected_improvement<Model, Number> {
+  using Base = expected_improvement<Model, Number>;
+
+ public:
+  using classifier_t =
+      gaussian::classifier<typename Model::process_t>;
+
+  expected_improvement_feasible(
+      const Model& model,  //
+      Number best,         //
+      const classifier_t& feasible)
+      : Base{model, best}, feasible_{feasible} {
+  }
+
+  template <class Input>
+  auto operator()(const Input& x) const {
+    return Base::operator()(x) +
+           feasible_.log_probability(x);
+  }
+
+  // Value only, over a batch (screening)
+  template <class Input>
+  auto score(const std::vector<Input>& x) const
+      -> std::vector<Number> {
+    auto result = Base::score(x);
+    const auto log_p = feasible_.log_probability(x);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      result[i] += log_p[i];
+    }
+    return result;
+  }
+
+ private:
+  const classifier_t& feasible_;
+};
+
+}  // namespace b2o::acquisition
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "acquisition/expected_improvement.hpp"
+
+namespace b2o::acquisition {
+
+// @brief Expected improvement per unit cost
+//
+//   a(x) = log EI(x) - m_c(x) = log(EI(x) / c(x)) ,
+//
+// where m_c is the mean of a second process fitted on the
+// log of the evaluation costs, c(x) = exp(m_c(x)). Costs
+// are relative (the optimizer subtracts a constant log
+// offset), only their ratios matter. An empty cost model
+// gives plain expected improvement.
+//
+template <class Model, class Number>
+class expected_improvement_per_cost
+    : public expected_improvement<Model, Number> {
+  using Base = expected_improvement<Model, Number>;
+
+ public:
+  using cost_model_t = typename Model::process_t;
+
+  expected_improvement_per_cost(
+      const Model& model,  //
+      Number best,         //
+      const cost_model_t& cost)
+      : Base{model, best}, cost_{cost} {
+  }
+
+  template <class Input>
+  auto operator()(const Input& x) const {
+    const auto [log_cost, _] = cost_.predict(x);
+    return Base::operator()(x) - log_cost;
+  }
+
+  // Value only, over a batch (screening)
+  template <class Input>
+  auto score(const std::vector<Input>& x) const
+      -> std::vector<Number> {
+    auto result = Base::score(x);
+    const auto cost = cost_.predict(x);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      result[i] -= cost[i].first;
+    }
+    return result;
+  }
+
+ private:
+  const cost_model_t& cost_;
+};
+
+}  // namespace b2o::acquisition
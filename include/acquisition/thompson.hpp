@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "dual/operations/negative.hpp"
+
+namespace b2o::acquisition {
+
+// @brief Thompson sampling
+//
+// Every acquisition draws its own posterior sample path
+// f ~ GP | data (gaussian/path.hpp) and the optimizer
+// maximizes -f(x), i.e. looks for the minimum of one
+// plausible objective. Draws are independent: proposals of
+// a batch run concurrently, one path each. Given a seed
+// (the optimizer draws them from the domain stream) the
+// path is reproducible, otherwise it comes from one
+// generator per thread, seeded at random.
+//
+template <class Model, class Number>
+class thompson {
+ public:
+  using number_t = Number;
+  using model_t = Model;
+  using path_t = typename Model::path_t;
+
+  static constexpr auto independent = true;
+
+  thompson(const Model& model, Number)
+      : path_{model.sample(generator())} {
+  }
+
+  // @param seed Seed of the sample path generator
+  thompson(const Model& model, Number, std::uint64_t seed)
+      : path_{draw(model, seed)} {
+  }
+
+  template <class Input>
+  auto operator()(const Input& x) const {
+    return -path_(x);
+  }
+
+  // Value only, over a batch (screening)
+  template <class Input>
+  auto score(const std::vector<Input>& x) const
+      -> std::vector<Number> {
+    auto result = std::vector<Number>{};
+    result.reserve(x.size());
+    for (const auto& xi : x) {
+      result.emplace_back(-path_(xi));
+    }
+    return result;
+  }
+
+ private:
+  static auto draw(const Model& model, std::uint64_t seed)
+      -> path_t {
+    auto rng = std::mt19937_64{seed};
+    return model.sample(rng);
+  }
+
+  static auto generator() -> std::mt19937_64& {
+    thread_local auto rng =
+        std::mt19937_64{std::random_device{}()};
+    return rng;
+  }
+
+  path_t path_;
+};
+
+}  // namespace b2o::acquisition
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace b2o::acquisition {
+
+// @brief Independent acquisitions
+//
+// An acquisition is independent when it declares
+//
+//   static constexpr bool independent = true ,
+//
+// i.e. the proposals of a batch need not see each other
+// (e.g. Thompson sampling draws). The optimizer then runs
+// them concurrently instead of conditioning each one on
+// the previous ones.
+//
+template <class Acquisition, class = void>
+struct is_independent : std::false_type {};
+
+template <class Acquisition>
+struct is_independent<
+    Acquisition,
+    std::void_t<decltype(Acquisition::independent)>>
+    : std::bool_constant<Acquisition::independent> {};
+
+template <class Acquisition>
+inline constexpr auto is_independent_v =
+    is_independent<Acquisition>::value;
+
+// @brief Batched acquisitions
+//
+// An acquisition is batched when it scores many inputs at
+// once by value only (no dual numbers),
+//
+//   score(x)   [a(x1), ..., a(xm)] ,
+//
+// which the optimizer uses to screen candidate starts.
+//
+template <class Acquisition, class Input, class = void>
+struct is_batched : std::false_type {};
+
+template <class Acquisition, class Input>
+struct is_batched<
+    Acquisition,
+    Input,
+    std::void_t<decltype(std::declval<const Acquisition&>()
+                             .score(std::declval<
+                                    const std::vector<
+                                        Input>&>()))>>
+    : std::true_type {};
+
+template <class Acquisition, class Input>
+inline constexpr auto is_batched_v =
+    is_batched<Acquisition, Input>::value;
+
+// @brief Seeded acquisitions
+//
+// An acquisition is seeded when it draws at random (e.g.
+// a sample path) and can be built with the seed of its
+// generator,
+//
+//   Acquisition{model, best, seed} ,
+//
+// which the optimizer draws from the domain stream, so
+// that runs of a seeded domain are reproducible.
+//
+template <class Acquisition, class Model, class Number>
+inline constexpr auto is_seeded_v =
+    std::is_constructible_v<
+        Acquisition,
+        const Model&,
+        Number,
+        std::uint64_t>;
+
+}  // namespace b2o::acquisition
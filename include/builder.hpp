@@ -1,13 +1,27 @@
 #pragma once
 #include <cstddef>
+#include <string>
 #include <utility>
 
 #include "acquisition/expected_improvement.hpp"
+#include "acquisition/expected_improvement_feasible.hpp"
+#include "acquisition/expected_improvement_per_cost.hpp"
+#include "acquisition/thompson.hpp"
 #include "domain/bounds.hpp"
+#include "domain/embedding.hpp"
 #include "gaussian/process.hpp"
+#include "helpers/logging.hpp"
+#include "kernel/algebra.hpp"
+#include "kernel/matern.hpp"
 #include "kernel/radial.hpp"
 #include "optimization/bayesian.hpp"
+#include "optimization/cmaes.hpp"
+#include "optimization/fidelity.hpp"
 #include "optimization/gradient.hpp"
+#include "optimization/lbfgsb.hpp"
+#include "optimization/study.hpp"
+#include "solver/direct.hpp"
+#include "solver/iterative.hpp"
 
 namespace b2o {
 
@@ -21,6 +35,8 @@ class objective_builder {
   Model model_;
   Domain domain_;
   Functor functor_;
+  std::string journal_;
+  std::size_t batch_{0};
 
  public:
   // Takes ownership of model, domain, and functor
@@ -30,17 +46,52 @@ class objective_builder {
         functor_{std::move(f)} {
   }
 
-  // Build the final Bayesian optimizer (consumes builder)
+  // Append every evaluation to a journal file and resume
+  // from its records if it exists (helpers/journal.hpp),
+  // build() throws std::system_error if it cannot be
+  // opened
+  auto journal(std::string path, std::size_t batch = 8) && {
+    journal_ = std::move(path);
+    batch_ = batch;
+    return std::move(*this);
+  }
+
+  // Build the final Bayesian optimizer (consumes builder),
+  // expected improvement, gradient ascent and no logging
+  // unless other policies are given, e.g.
+  //   build<acquisition::thompson>() ,
+  //   build<acquisition::expected_improvement,
+  //         optimization::lbfgsb,
+  //         logging::buffered>()
+  // the last policy observes the acquisition optimizers
+  // (iterations of each proposal), e.g.
+  //   build<acquisition::expected_improvement,
+  //         optimization::lbfgsb,
+  //         logging::buffered,
+  //         logging::structured>()
+  template <
+      template <class...> class Acquisition =
+          acquisition::expected_improvement,
+      template <class...> class Optimizer =
+          optimization::gradient,
+      class Observer = logging::none,
+      class OptimizerObserver = logging::none>
   auto build() && {
-    return optimization::bayesian<
-        acquisition::expected_improvement,
-        optimization::gradient,
+    using bayesian_t = optimization::bayesian<
+        Acquisition,
+        Optimizer,
         Model,
         Domain,
-        Functor>{
+        Functor,
+        Observer,
+        OptimizerObserver>;
+    using journal_t = typename bayesian_t::journal_t;
+    return bayesian_t{
         std::move(model_),
         std::move(domain_),
-        std::move(functor_)};
+        std::move(functor_),
+        journal_.empty() ? journal_t{}
+                         : journal_t{journal_, batch_}};
   }
 };
 
@@ -68,13 +119,71 @@ class domain_builder {
         std::move(domain_),
         std::move(fn)};
   }
+
+  // Multi-fidelity objective entry point, one functor of
+  // the first D - 1 inputs per level, the last input being
+  // the fidelity (fixed at the highest level in the
+  // domain, seeded from this one; warmup draws cheap
+  // levels, see bayesian::run_fidelity), e.g.
+  //   fidelities(optimization::fidelity{0.5, 1.0, cheap},
+  //              optimization::fidelity{1.0, 20.0, f})
+  template <class Number, class... Functors>
+  auto fidelities(
+      optimization::fidelity<Number, Functors>... f) && {
+    auto functor =
+        optimization::fidelities{std::move(f)...};
+    const auto target = functor.target();
+    auto config = domain_.config();
+    auto start = domain_.start();
+    config.back() = {target, target};
+    start.back() = target;
+    auto domain = Domain{config, start};
+    domain.seed(domain_.next_seed());
+    return objective_builder<
+        Model,
+        Domain,
+        decltype(functor)>{
+        std::move(model_),
+        std::move(domain),
+        std::move(functor)};
+  }
+
+  // Ask/tell study without objective (consumes builder),
+  // the caller evaluates the asked inputs
+  template <
+      template <class...> class Acquisition =
+          acquisition::expected_improvement,
+      template <class...> class Optimizer =
+          optimization::gradient,
+      class Observer = logging::none,
+      class OptimizerObserver = logging::none,
+      class Study = optimization::study<
+          Acquisition,
+          Optimizer,
+          Model,
+          Domain,
+          Observer,
+          OptimizerObserver>>
+  auto study(
+      typename Study::config_t config,
+      std::size_t depth = 2) && {
+    return Study{
+        std::move(model_),
+        std::move(domain_),
+        config,
+        depth};
+  }
 };
 
 // ============================================================
 // Stage 2: Kernel Builder
 // User selects kernel and defines the domain.
 // ============================================================
-template <std::size_t Dimension, class Number, class Kernel>
+template <
+    std::size_t Dimension,
+    class Number,
+    class Kernel,
+    template <class...> class Solver = math::direct>
 class kernel_builder {
   Kernel kernel_;
 
@@ -84,6 +193,15 @@ class kernel_builder {
       : kernel_(std::move(k)) {
   }
 
+  // Linear algebra of the Gaussian process (math::direct
+  // unless given), e.g. solver<math::iterative>() for
+  // thousands of samples
+  template <template <class...> class Other>
+  auto solver() && {
+    return kernel_builder<Dimension, Number, Kernel, Other>(
+        std::move(kernel_));
+  }
+
   // Convenience domain bounds constructor
   template <class... Ts>
   auto domain_bounds(Ts&&... args) && {
@@ -102,7 +220,7 @@ class kernel_builder {
   template <class Domain>
   auto make_domain(Domain domain) {
     return domain_builder{
-        gaussian::make_process<Dimension>(
+        gaussian::make_process<Dimension, Solver>(
             std::move(kernel_)),
         std::move(domain)};
   }
@@ -122,7 +240,27 @@ class optimizer_builder {
         kernel::radial{std::forward<T>(sigma)});
   }
 
-  // Custom kernel entry point (user-defined kernels)
+  // Convenience Matern kernel constructors
+  template <class T>
+  auto kernel_matern12(T&& sigma) {
+    return make_kernel(
+        kernel::matern12{std::forward<T>(sigma)});
+  }
+
+  template <class T>
+  auto kernel_matern32(T&& sigma) {
+    return make_kernel(
+        kernel::matern32{std::forward<T>(sigma)});
+  }
+
+  template <class T>
+  auto kernel_matern52(T&& sigma) {
+    return make_kernel(
+        kernel::matern52{std::forward<T>(sigma)});
+  }
+
+  // Custom kernel entry point (user-defined kernels and
+  // kernel algebra expressions, see kernel/algebra.hpp)
   template <class Kernel>
   auto kernel(Kernel&& kernel) {
     return make_kernel(std::forward<Kernel>(kernel));
@@ -2,9 +2,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <random>
+#include <vector>
 
 namespace b2o::domain {
 
@@ -27,10 +30,30 @@ class bounds {
     rng_.seed(std::forward<T>(value));
   }
 
+  // Copy drawing from its own stream, seeded from this one
+  // (one per concurrent task)
+  auto fork() -> bounds {
+    auto result = *this;
+    auto seed = std::seed_seq{rng_(), rng_(), rng_()};
+    result.rng_.seed(seed);
+    return result;
+  }
+
+  // Seed of another generator (e.g. of a randomized
+  // acquisition), drawn from this stream
+  auto next_seed() -> std::uint64_t {
+    const auto high = std::uint64_t{rng_()};
+    return (high << 32) | rng_();
+  }
+
   auto start() const -> const input_t& {
     return start_;
   }
 
+  auto config() const -> const config_t& {
+    return config_;
+  }
+
   auto random() -> input_t {
     return build({}, [this](auto, auto lo, auto hi) {
       std::uniform_real_distribution<Number> dist(lo, hi);
@@ -42,6 +65,10 @@ class bounds {
     constexpr auto zero = Number{0};
     constexpr auto one = Number{1};
     return build(center, [this](auto x, auto lo, auto hi) {
+      // fixed coordinate (lo == hi)
+      if (!(lo < hi)) {
+        return lo;
+      }
       const auto points = std::array{lo, x, hi};
       const auto weights = std::array{zero, one, zero};
       std::piecewise_linear_distribution<Number> dist{
@@ -52,6 +79,29 @@ class bounds {
     });
   }
 
+  // n quasi-random inputs covering the box: the Halton
+  // sequence (one prime base per dimension), shifted by a
+  // random offset modulo 1 so that calls differ
+  auto candidates(std::size_t n) -> std::vector<input_t> {
+    auto unit = std::uniform_real_distribution<Number>{};
+    auto shift = input_t{};
+    for (auto& s : shift) {
+      s = unit(rng_);
+    }
+    auto result = std::vector<input_t>{};
+    result.reserve(n);
+    for (std::size_t i = 1; i <= n; ++i) {
+      auto d = std::size_t{0};
+      result.emplace_back(
+          build(shift, [&](auto s, auto lo, auto hi) {
+            auto u = radical_inverse(i, primes_[d++]) + s;
+            u = (u < Number{1}) ? u : u - Number{1};
+            return lo + u * (hi - lo);
+          }));
+    }
+    return result;
+  }
+
   auto project(const input_t& value) const -> input_t {
     return build(value, [](auto x, auto lo, auto hi) {
       return std::clamp(x, lo, hi);
@@ -59,6 +109,36 @@ class bounds {
   }
 
  protected:
+  static auto radical_inverse(
+      std::size_t i, std::size_t base) -> Number {
+    const auto inverse = Number{1} / Number(base);
+    auto scale = inverse;
+    auto result = Number{0};
+    for (; i > 0; i /= base) {
+      result += Number(i % base) * scale;
+      scale *= inverse;
+    }
+    return result;
+  }
+
+  static constexpr auto first_primes() {
+    auto primes = std::array<std::size_t, N>{};
+    auto p = std::size_t{2};
+    for (auto& prime : primes) {
+      for (;; ++p) {
+        auto is_prime = true;
+        for (auto q = std::size_t{2}; q * q <= p; ++q) {
+          is_prime = is_prime && (p % q != 0);
+        }
+        if (is_prime) {
+          break;
+        }
+      }
+      prime = p++;
+    }
+    return primes;
+  }
+
   template <class Fn>
   auto build(const input_t& value, Fn fn) const -> input_t {
     input_t result{};
@@ -75,6 +155,8 @@ class bounds {
   }
 
  private:
+  static constexpr auto primes_ = first_primes();
+
   config_t config_;
   input_t start_;
   generator_t rng_;
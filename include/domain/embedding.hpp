@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <utility>
+
+#include "domain/bounds.hpp"
+
+namespace b2o::domain {
+
+// Hashed random subspace (HeSBO) of a box of dimension N
+//
+// Every input coordinate i follows one of the E embedded
+// coordinates, with a random sign:
+//
+//   u_i = s_i z_h(i) ,  z in [-1, 1]^E ,
+//   x_i = lo_i + (u_i + 1) (hi_i - lo_i) / 2 ,
+//
+// h balanced (every z_j drives N / E inputs). Every z
+// lifts into the box, no clipping, and the model, kernel
+// and dual numbers only see E coordinates, e.g.
+//
+//   auto e = embedding<double, 500, 8>{limits};
+//   auto opt = make_optimizer<8>().kernel_matern52(1.0)
+//                  .domain(e.domain(start))
+//                  .objective(e.wrap(f))
+//                  .build();
+//   ... e.lift(opt.best().first)
+//
+template <class Number, std::size_t N, std::size_t E>
+class embedding {
+  static_assert(E > 0 && E <= N);
+
+ public:
+  using number_t = Number;
+  using input_t = std::array<Number, E>;
+  using output_t = std::array<Number, N>;
+  using range_t = std::pair<Number, Number>;
+  using config_t = std::array<range_t, N>;
+  using domain_t = bounds<Number, E>;
+
+  // Objective of the embedded coordinates
+  template <class Functor>
+  class lifted {
+   public:
+    lifted(const embedding& e, Functor f)
+        : embedding_{e}, functor_{std::move(f)} {
+    }
+
+    auto operator()(const input_t& z) {
+      return functor_(embedding_.lift(z));
+    }
+
+    auto operator()(const input_t& z) const {
+      return functor_(embedding_.lift(z));
+    }
+
+   private:
+    embedding embedding_;
+    Functor functor_;
+  };
+
+  explicit embedding(
+      const config_t& config,
+      std::size_t seed = std::random_device{}())
+      : config_{config} {
+    auto rng = std::mt19937_64{seed};
+    auto order = std::array<std::size_t, N>{};
+    std::iota(std::begin(order), std::end(order), 0);
+    std::shuffle(std::begin(order), std::end(order), rng);
+    auto coin = std::bernoulli_distribution{};
+    for (std::size_t k = 0; k < N; ++k) {
+      index_[order[k]] = k % E;
+      sign_[order[k]] = coin(rng) ? Number{1} : Number{-1};
+    }
+  }
+
+  auto config() const -> const config_t& {
+    return config_;
+  }
+
+  auto lift(const input_t& z) const -> output_t {
+    auto x = output_t{};
+    for (std::size_t i = 0; i < N; ++i) {
+      const auto& [lo, hi] = config_[i];
+      const auto u = sign_[i] * z[index_[i]];
+      x[i] = lo + (u + Number{1}) * (hi - lo) / Number{2};
+    }
+    return x;
+  }
+
+  // Least squares embedded coordinates of an input (the
+  // mean of its signed, rescaled coordinates per z_j)
+  auto project(const output_t& x) const -> input_t {
+    auto z = input_t{};
+    auto count = std::array<std::size_t, E>{};
+    for (std::size_t i = 0; i < N; ++i) {
+      const auto& [lo, hi] = config_[i];
+      const auto u =
+          Number{2} * (x[i] - lo) / (hi - lo) - Number{1};
+      z[index_[i]] += sign_[i] * u;
+      ++count[index_[i]];
+    }
+    for (std::size_t j = 0; j < E; ++j) {
+      z[j] = std::clamp(
+          z[j] / Number(count[j]), Number{-1}, Number{1});
+    }
+    return z;
+  }
+
+  // Domain of the embedded coordinates, [-1, 1]^E
+  auto domain(const output_t& start) const -> domain_t {
+    auto limits = typename domain_t::config_t{};
+    limits.fill({Number{-1}, Number{1}});
+    return domain_t{limits, project(start)};
+  }
+
+  template <class Functor>
+  auto wrap(Functor f) const -> lifted<Functor> {
+    return lifted<Functor>{*this, std::move(f)};
+  }
+
+ private:
+  config_t config_;
+  std::array<std::size_t, N> index_{};
+  std::array<Number, N> sign_{};
+};
+
+}  // namespace b2o::domain
@@ -1,4 +1,5 @@
 #pragma once
+#include "dual/operations/cos.hpp"
 #include "dual/operations/divides.hpp"
 #include "dual/operations/erf.hpp"
 #include "dual/operations/exp.hpp"
@@ -7,4 +8,5 @@
 #include "dual/operations/multiplies.hpp"
 #include "dual/operations/negative.hpp"
 #include "dual/operations/plus.hpp"
+#include "dual/operations/sin.hpp"
 #include "dual/operations/sqrt.hpp"
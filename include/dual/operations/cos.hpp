@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cmath>
+
+#include "dual/operations/base.hpp"
+
+namespace b2o::dual {
+struct cos : unary_operation<cos> {
+  template <class T>
+  auto value(const T& v) const {
+    return std::cos(v);
+  }
+  template <class T>
+  auto dvalue(const duo<T>& n) const {
+    return -std::sin(n.v) * n.d;
+  }
+};
+}  // namespace b2o::dual
+
+namespace std {
+template <class T, b2o::dual::cos::enable_t<T> = 0>
+inline auto cos(const T& n) {
+  return std::invoke(b2o::dual::cos{}, n);
+}
+}  // namespace std
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cmath>
+
+#include "dual/operations/base.hpp"
+
+namespace b2o::dual {
+struct sin : unary_operation<sin> {
+  template <class T>
+  auto value(const T& v) const {
+    return std::sin(v);
+  }
+  template <class T>
+  auto dvalue(const duo<T>& n) const {
+    return std::cos(n.v) * n.d;
+  }
+};
+}  // namespace b2o::dual
+
+namespace std {
+template <class T, b2o::dual::sin::enable_t<T> = 0>
+inline auto sin(const T& n) {
+  return std::invoke(b2o::dual::sin{}, n);
+}
+}  // namespace std
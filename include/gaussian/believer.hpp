@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "solver/cholesky.hpp"
+
+namespace b2o::gaussian {
+
+// @brief Kriging believer over a fixed model
+//
+// Pending inputs F = [f1, ..., fq] (proposed, not yet
+// evaluated) are believed to return the posterior mean, so
+// the mean is unchanged and the variance is conditioned on
+// them through the joint posterior:
+//
+//   var(x | F) = var(x) - c.T * C.inv * c ,
+//
+//   where:
+//     c_j = cov(x, f_j)               ,
+//     C   = cov(F, F) + sn.var * I    ,
+//     C   = L L.T                     .
+//
+// Inputs close to pending ones lose their uncertainty, an
+// acquisition over the believer looks elsewhere. The model
+// is only read; C is refactored on every condition (q is
+// small, the weights of the model are computed once per
+// pending input).
+//
+template <class Model>
+class believer {
+  using Matrix = std::vector<std::vector<
+      typename Model::number_t>>;
+  using Result = std::pair<
+      typename Model::number_t,
+      typename Model::number_t>;
+
+ public:
+  using number_t = typename Model::number_t;
+  using sample_t = typename Model::sample_t;
+  using input_t = typename sample_t::first_type;
+  using process_t = typename Model::process_t;
+
+  static constexpr auto kJitter = number_t{1e-9};
+
+  explicit believer(const Model& model) : model_{model} {
+  }
+
+  auto condition(const input_t& f) -> void {
+    f_.emplace_back(f);
+    w_.emplace_back(std::move(model_.weights({f})[0]));
+    auto c = Matrix{};
+    for (const auto& fi : f_) {
+      auto [_, var, cov] = model_.predict(fi, f_, w_);
+      cov[c.size()] += model_.noise() + kJitter;
+      c.emplace_back(std::move(cov));
+    }
+    factor_.build(c, l_);
+  }
+
+  auto pending() const -> const std::vector<input_t>& {
+    return f_;
+  }
+
+  template <class Input>
+  auto predict(const Input& x) const {
+    using Value = typename Input::value_type;
+    auto [mean, variance, cov] = model_.predict(x, f_, w_);
+    auto u = std::vector<Value>{};
+    factor_.forward(l_, cov, u);
+    for (const auto& ui : u) {
+      variance = variance - ui * ui;
+    }
+    return std::tuple{mean, std::max(variance, Value{0})};
+  }
+
+  // Batch prediction (value only)
+  auto predict(const std::vector<input_t>& x) const
+      -> std::vector<Result> {
+    auto result = std::vector<Result>{};
+    result.reserve(x.size());
+    for (const auto& xi : x) {
+      const auto [mean, variance] = predict(xi);
+      result.emplace_back(mean, variance);
+    }
+    return result;
+  }
+
+ private:
+  const Model& model_;
+  math::cholesky<number_t> factor_;
+  std::vector<input_t> f_;
+  Matrix w_;
+  Matrix l_;
+};
+
+}  // namespace b2o::gaussian
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "dual/operations/log.hpp"
+#include "dual/operations/sqrt.hpp"
+#include "gaussian/distribution.hpp"
+
+namespace b2o::gaussian {
+
+// @brief Probability of feasibility
+//
+// A latent process g regresses the labels (+1 feasible,
+// -1 infeasible, with some label noise so that nearby
+// contradicting labels stay well conditioned), an input
+// is feasible where g > 0:
+//
+//   p(x) = P(g(x) > 0) = Phi(m(x) / sqrt(v(x))) .
+//
+// Unexplored inputs get p = 1/2, evaluated ones go to
+// their label (0 or 1) as the variance shrinks. Inputs
+// may be dual numbers (gradients of the acquisition).
+//
+template <class Process>
+class classifier {
+  static constexpr auto kJitter =
+      typename Process::number_t{1e-12};
+  static constexpr auto kNoise =
+      typename Process::number_t{0.1};
+
+ public:
+  using number_t = typename Process::number_t;
+  using sample_t = typename Process::sample_t;
+  using input_t = typename sample_t::first_type;
+  using label_t = std::pair<input_t, bool>;
+  using distribution_t = distribution<number_t>;
+
+  // @param model Process of the kernel and solver
+  // @param noise Label noise (standard deviation)
+  explicit classifier(
+      const Process& model, number_t noise = kNoise)
+      : model_{model.prior(noise)} {
+  }
+
+  auto size() const -> std::size_t {
+    return model_.size();
+  }
+
+  auto emplace(const input_t& x, bool feasible) -> void {
+    model_.emplace(x, label(feasible));
+  }
+
+  // Bulk load (resume), one full factorization
+  auto load(const std::vector<label_t>& labels) -> void {
+    auto samples = std::vector<sample_t>{};
+    samples.reserve(labels.size());
+    for (const auto& [x, feasible] : labels) {
+      samples.emplace_back(x, label(feasible));
+    }
+    model_.load(samples);
+  }
+
+  template <class Input>
+  auto probability(const Input& x) const {
+    const auto [mu, var] = model_.predict(x);
+    return squash(mu, var);
+  }
+
+  template <class Input>
+  auto log_probability(const Input& x) const {
+    return std::log(probability(x) + kJitter);
+  }
+
+  // Value only, over a batch (screening)
+  auto log_probability(const std::vector<input_t>& x) const
+      -> std::vector<number_t> {
+    auto result = std::vector<number_t>{};
+    result.reserve(x.size());
+    for (const auto& [mu, var] : model_.predict(x)) {
+      result.emplace_back(
+          std::log(squash(mu, var) + kJitter));
+    }
+    return result;
+  }
+
+ protected:
+  static auto label(bool feasible) -> number_t {
+    return feasible ? number_t{1} : number_t{-1};
+  }
+
+  template <class NumberLike>
+  auto squash(const NumberLike& mu, const NumberLike& var)
+      const {
+    return distribution_.cdf(
+        mu / std::sqrt(var + kJitter));
+  }
+
+ private:
+  Process model_;
+  distribution_t distribution_{};
+};
+
+}  // namespace b2o::gaussian
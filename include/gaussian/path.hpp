@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "dual/operations/cos.hpp"
+
+namespace b2o::gaussian {
+
+// @brief Posterior sample path (pathwise conditioning)
+//
+// One sample of the posterior as a function, cheap to
+// evaluate anywhere and differentiable:
+//
+//   f(x) = sum_i w_i phi_i(x) + sum_j v_j k(x, xj) ,
+//
+//   where:
+//     phi_i(x) = sqrt(2 s / L) cos(o_i.T x + b_i)   ,
+//     o_i      ~ spectral density of k              ,
+//     b_i      ~ U(0, 2 pi) ,  w ~ N(0, I)          ,
+//     s        = k(x, x)                            ,
+//
+//     v = K.inv * (Y - Phi(X) * w - e) ,
+//     e ~ N(0, sn.var * I) .
+//
+// The first term is a prior draw with L random Fourier
+// features, the second term its update on the training
+// data (one solve, see process::sample).
+//
+template <class Kernel, class Number, std::size_t Dimension>
+class path {
+  using Input = std::array<Number, Dimension>;
+
+  static constexpr auto kTwoPi =
+      Number{6.28318530717958647692528676655900577L};
+
+ public:
+  using number_t = Number;
+
+  template <class Rng>
+  path(const Kernel& kernel, std::size_t features, Rng& rng)
+      : kernel_{kernel} {
+    auto normal = std::normal_distribution<Number>{};
+    auto phase = std::uniform_real_distribution<Number>{
+        Number{0}, kTwoPi};
+    const auto amplitude = std::sqrt(
+        Number{2} * kernel.variance() /
+        static_cast<Number>(features));
+    omega_.reserve(features);
+    phase_.reserve(features);
+    weight_.reserve(features);
+    for (std::size_t i = 0; i < features; ++i) {
+      omega_.emplace_back(
+          kernel.template spectral<Dimension>(rng));
+      phase_.emplace_back(phase(rng));
+      weight_.emplace_back(amplitude * normal(rng));
+    }
+  }
+
+  // sum_i w_i phi_i(x)
+  template <class NumberLike>
+  auto prior(
+      const std::array<NumberLike, Dimension>& x) const
+      -> NumberLike {
+    auto sum = NumberLike{};
+    for (std::size_t i = 0; i < omega_.size(); ++i) {
+      auto arg = NumberLike{};
+      for (std::size_t d = 0; d < Dimension; ++d) {
+        arg = arg + omega_[i][d] * x[d];
+      }
+      sum = sum + weight_[i] * std::cos(arg + phase_[i]);
+    }
+    return sum;
+  }
+
+  // Install the update weights v on the inputs x
+  auto update(
+      std::vector<Input> x, std::vector<Number> v)
+      -> void {
+    x_ = std::move(x);
+    v_ = std::move(v);
+  }
+
+  template <class NumberLike>
+  auto operator()(
+      const std::array<NumberLike, Dimension>& x) const
+      -> NumberLike {
+    auto sum = prior(x);
+    for (std::size_t j = 0; j < x_.size(); ++j) {
+      sum = sum + v_[j] * kernel_(x, x_[j]);
+    }
+    return sum;
+  }
+
+ private:
+  Kernel kernel_;
+  std::vector<Input> omega_;
+  std::vector<Number> phase_;
+  std::vector<Number> weight_;
+  std::vector<Input> x_;
+  std::vector<Number> v_;
+};
+
+}  // namespace b2o::gaussian
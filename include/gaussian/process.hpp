@@ -2,14 +2,20 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <iterator>
 #include <numeric>
+#include <random>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
-#include "solver/cholesky.hpp"
+#include "gaussian/path.hpp"
+#include "kernel/traits.hpp"
+#include "math/gemm.hpp"
+#include "solver/direct.hpp"
 
 namespace b2o::gaussian {
 // @brief Gaussian Process Regression
@@ -23,10 +29,12 @@ namespace b2o::gaussian {
 //   sn.var   Noise variance ,
 //
 // Kernel matrix:
-//   K = K(X, X) + sn.var * I ,
+//   K = K(X, X) + sn.var * I + diag(e) ,
 //
 //   where:
 //     K_ij = k(xi, xj)     ,
+//     e_i  extra noise variance of sample i (0 unless
+//          emplaced with one, e.g. low-fidelity samples) ,
 //
 // Kernel vector:
 //   k_* = k(X, x*) =      ,
@@ -50,10 +58,40 @@ namespace b2o::gaussian {
 // Predictive variance:
 //   var(x*) = k(x*, x*) − dot(v,v))
 //
+// Log marginal likelihood:
+//   log p(y) = -0.5 * y.T * a - 0.5 * log|K| - n/2 log(2 pi)
 //
-template <class Kernel, class Number, std::size_t Dimension>
+// The linear algebra is delegated to the Solver policy
+// (math::direct by default, math::iterative for large n):
+//
+//   build(K, sn.var)     full (re)factorization ,
+//   update(K, sn.var)    last row/column appended ,
+//   solve(K, y, a)       a = K.inv * y ,
+//   quadratic(K, k*)     k*.T * K.inv * k* = dot(v,v) ,
+//   inverse(K, b)        K.inv * b ,
+//   log_determinant(K)   log|K| .
+//
+// Joint posterior of several inputs S (batch proposals):
+//
+//   mean(S)   = K(S, X) * a ,
+//   cov(S, S) = K(S, S) - K(S, X) * K.inv * K(X, S) .
+//
+// Metric kernels (kernel/traits.hpp) have their blocks
+// built from the cached scaled inputs S = scale(X) and
+// their squared norms, with a blocked matrix product:
+//
+//   r2(A, S) = |a|^2 + |s|^2 - 2 A * S.T ,
+//   K(A, X)  = profile(r2) ,
+//
+// used by the full kernel, appended rows and the cross
+// kernel of batch predictions.
+//
+template <
+    class Kernel,
+    class Number,
+    std::size_t Dimension,
+    class Solver = math::direct<Number>>
 class process {
-  using Solver = math::cholesky<Number>;
   template <class NumberLike>
   using Vector = std::vector<NumberLike>;
   template <class NumberLike>
@@ -70,28 +108,62 @@ class process {
   using Result = std::pair<Number, Number>;
 
   static constexpr auto kJitter = 1e-12;
+  static constexpr auto kFeatures = size_t{256};
+  static constexpr auto kMetric =
+      kernel::is_metric_v<Kernel>;
+  static constexpr auto kBlock = size_t{64};
+  static constexpr auto kLog2Pi =
+      Number{1.83787706640934548356065947281123527L};
 
  public:
   using number_t = Number;
   using sample_t = Sample<Number>;
+  using path_t = path<Kernel, Number, Dimension>;
+  using process_t = process;
 
   template <class Dataset = Samples<Number>>
   process(
       const Kernel& kernel,    //
       const Dataset& samples,  //
-      const Number noise)
+      const Number noise,      //
+      const Solver& solver = Solver{})
       : k_func_{kernel},
-        k_noise_{std::max(noise * noise, kJitter)} {
+        k_noise_{std::max(noise * noise, kJitter)},
+        solver_{solver} {
     samples_init(samples);
     kernel_init();
     solve_full();
   }
 
   auto size() const -> size_t {
-    assert(k_.size() == l_.size());
+    assert(k_.size() == x_.size());
     return k_.size();
   }
 
+  auto noise() const -> Number {
+    return k_noise_;
+  }
+
+  // Same kernel, noise and solver, no samples
+  auto prior() const -> process {
+    auto result = process{*this};
+    result.samples_init(Samples<Number>{});
+    result.kernel_init();
+    result.solve_full();
+    return result;
+  }
+
+  // Same kernel and solver, another noise (standard
+  // deviation), no samples
+  auto prior(const Number noise) const -> process {
+    auto result = process{*this};
+    result.k_noise_ = std::max(noise * noise, kJitter);
+    result.samples_init(Samples<Number>{});
+    result.kernel_init();
+    result.solve_full();
+    return result;
+  }
+
   auto emplace(const Input<Number>& x, const Number& y)
       -> void {
     samples_update(x, y);
@@ -104,20 +176,165 @@ class process {
     emplace(x, y);
   }
 
+  // Sample with an extra noise variance of its own
+  auto emplace(
+      const Input<Number>& x,
+      const Number& y,
+      const Number& noise) -> void {
+    samples_update(x, y, noise);
+    kernel_update(x);
+    solve_last();
+  }
+
+  // Bulk emplace: all the samples enter the kernel matrix,
+  // then one solve
+  auto emplace(const Samples<Number>& samples) -> void {
+    for (const auto& sample : samples) {
+      append(sample);
+    }
+    solve_last();
+  }
+
+  // Bulk emplace with extra noise variances (one per
+  // sample, 0 for exact ones)
+  auto emplace(
+      const Samples<Number>& samples,
+      const Vector<Number>& noises) -> void {
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const auto& [x, y] = samples[i];
+      samples_update(x, y, noises[i]);
+      kernel_update(x);
+    }
+    solve_last();
+  }
+
+  // Bulk load (resume): the samples enter the kernel
+  // matrix, then one full factorization
+  auto load(const Samples<Number>& samples) -> void {
+    for (const auto& sample : samples) {
+      append(sample);
+    }
+    solve_full();
+  }
+
   template <class NumberLike>
   auto predict(const Input<NumberLike>& s) const {
-    const auto solver = Solver{};
     const auto ss = k_func_(s, s);
     const auto xs = kernel_xs(s);
-    auto v = Vector<NumberLike>{};
-    solver.forward(l_, xs, v);
     const auto mean = dot_product(xs, a_);
-    const auto variance = ss - dot_product(v, v);
+    const auto variance = ss - solver_.quadratic(k_, xs);
     return std::tuple{
         mean, std::max(variance, NumberLike{0})};
   }
 
+  // Batch prediction, the cross kernel K(S, X) is built as
+  // one block
+  auto predict(const Inputs<Number>& s) const
+      -> Vector<Result<Number>> {
+    auto k_s = Matrix<Number>{};
+    kernel_cross(s, k_s);
+    auto result = Vector<Result<Number>>{};
+    result.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+      const auto ss = k_func_(s[i], s[i]);
+      const auto mean = dot_product(k_s[i], a_);
+      const auto variance =
+          ss - solver_.quadratic(k_, k_s[i]);
+      result.emplace_back(
+          mean, std::max(variance, Number{0}));
+    }
+    return result;
+  }
+
+  // Joint prediction, mean vector and covariance matrix
+  auto predict_joint(const Inputs<Number>& s) const
+      -> std::pair<Vector<Number>, Matrix<Number>> {
+    const auto n = s.size();
+    auto k_s = Matrix<Number>{};
+    kernel_cross(s, k_s);
+    auto cov = Matrix<Number>(n, Vector<Number>(n));
+    for (size_t i = 0; i < n; ++i) {
+      const auto w = solver_.inverse(k_, k_s[i]);
+      for (size_t j = 0; j <= i; ++j) {
+        const auto ss = k_func_(s[i], s[j]);
+        cov[i][j] = ss - dot_product(k_s[j], w);
+        cov[j][i] = cov[i][j];
+      }
+    }
+    return {dot_product(a_, k_s), std::move(cov)};
+  }
+
+  // Weights w_j = K.inv * k(X, f_j) of fixed inputs f,
+  // see predict(s, f, w)
+  auto weights(const Inputs<Number>& f) const
+      -> Matrix<Number> {
+    auto w = Matrix<Number>{};
+    kernel_cross(f, w);
+    for (auto& wj : w) {
+      wj = solver_.inverse(k_, wj);
+    }
+    return w;
+  }
+
+  // Mean, variance (not clamped) and covariances with the
+  // fixed inputs f, given w = weights(f):
+  //   cov(s, f_j) = k(s, f_j) - k*.T * w_j
+  template <class NumberLike>
+  auto predict(
+      const Input<NumberLike>& s,  //
+      const Inputs<Number>& f,     //
+      const Matrix<Number>& w) const {
+    const auto ss = k_func_(s, s);
+    const auto xs = kernel_xs(s);
+    const auto mean = dot_product(xs, a_);
+    const auto variance = ss - solver_.quadratic(k_, xs);
+    auto cov = Vector<NumberLike>{};
+    cov.reserve(f.size());
+    for (size_t j = 0; j < f.size(); ++j) {
+      const auto sf = k_func_(s, f[j]);
+      cov.emplace_back(sf - dot_product(xs, w[j]));
+    }
+    return std::tuple{mean, variance, std::move(cov)};
+  }
+
+  // Posterior sample path (gaussian/path.hpp), the kernel
+  // must provide spectral draws
+  template <class Rng>
+  auto sample(Rng& rng, size_t features = kFeatures) const
+      -> path_t {
+    auto f = path_t{k_func_, features, rng};
+    auto e = std::normal_distribution<Number>{};
+    auto r = Vector<Number>{};
+    r.reserve(size());
+    for (size_t j = 0; j < size(); ++j) {
+      const auto sd = std::sqrt(k_noise_ + e_[j]);
+      r.emplace_back(y_[j] - f.prior(x_[j]) - sd * e(rng));
+    }
+    f.update(x_, solver_.inverse(k_, r));
+    return f;
+  }
+
+  // Prior variance k(x, x), the scale of extra noises
+  auto variance(const Input<Number>& x) const -> Number {
+    return k_func_(x, x);
+  }
+
+  auto log_likelihood() const -> Number {
+    const auto n = static_cast<Number>(size());
+    const auto fit = dot_product(y_, a_);
+    const auto det = solver_.log_determinant(k_);
+    return Number{-0.5} * (fit + det + n * kLog2Pi);
+  }
+
  protected:
+  // The sample enters the kernel matrix, the solver state
+  // is stale until the next solve
+  auto append(const Sample<Number>& sample) -> void {
+    const auto& [x, y] = sample;
+    samples_update(x, y);
+    kernel_update(x);
+  }
+
   template <class Container>
   auto samples_init(const Container& samples) -> void {
     x_.clear();
@@ -128,22 +345,114 @@ class process {
       x_.emplace_back(x);
       y_.emplace_back(y);
     }
+    e_.assign(x_.size(), Number{0});
+    s_.clear();
+    norms_.clear();
+    for (const auto& x : x_) {
+      metric_update(x);
+    }
   }
 
   auto samples_update(
-      const Input<Number>& x, const Number& y) -> void {
+      const Input<Number>& x,
+      const Number& y,
+      const Number& noise = Number{0}) -> void {
     x_.emplace_back(x);
     y_.emplace_back(y);
+    e_.emplace_back(noise);
+    metric_update(x);
+  }
+
+  auto metric_update(const Input<Number>& x) -> void {
+    if constexpr (kMetric) {
+      const auto s = k_func_.scale(x);
+      s_.insert(std::end(s_), std::cbegin(s), std::cend(s));
+      norms_.emplace_back(squared_norm(s.data()));
+    }
+  }
+
+  static auto squared_norm(const Number* s) -> Number {
+    auto sum = Number{0};
+    for (size_t d = 0; d < Dimension; ++d) {
+      sum += s[d] * s[d];
+    }
+    return sum;
+  }
+
+  // k[i] = K(a_i, X) for the m scaled rows a and their
+  // squared norms, kBlock rows per matrix product
+  auto kernel_block(
+      const Number* a,      //
+      const Number* norms,  //
+      size_t m,             //
+      Matrix<Number>& k) const -> void {
+    constexpr auto two = Number{2};
+    const auto n = x_.size();
+    auto gemm = math::gemm<Number, Dimension>{};
+    auto r2 = Vector<Number>(std::min(m, kBlock) * n);
+    k.resize(m);
+    for (size_t i0 = 0; i0 < m; i0 += kBlock) {
+      const auto rows = std::min(kBlock, m - i0);
+      gemm(
+          a + i0 * Dimension, Dimension,  //
+          s_.data(), Dimension,           //
+          r2.data(), n, rows, n);
+      for (size_t i = 0; i < rows; ++i) {
+        auto* row = &r2[i * n];
+        const auto ni = norms[i0 + i];
+        for (size_t j = 0; j < n; ++j) {
+          const auto d = ni + norms_[j] - two * row[j];
+          row[j] = std::max(d, Number{0});
+        }
+        k[i0 + i].resize(n);
+        k_func_.profile(row, k[i0 + i].data(), n);
+      }
+    }
+  }
+
+  auto kernel_cross(
+      const Inputs<Number>& s, Matrix<Number>& k) const
+      -> void {
+    if constexpr (kMetric) {
+      auto scaled = Vector<Number>{};
+      auto norms = Vector<Number>{};
+      scaled.reserve(s.size() * Dimension);
+      norms.reserve(s.size());
+      for (const auto& x : s) {
+        const auto si = k_func_.scale(x);
+        scaled.insert(
+            std::end(scaled),  //
+            std::cbegin(si),
+            std::cend(si));
+        norms.emplace_back(squared_norm(si.data()));
+      }
+      kernel_block(
+          scaled.data(), norms.data(), s.size(), k);
+    } else {
+      k.clear();
+      k.reserve(s.size());
+      for (const auto& x : s) {
+        k.emplace_back(kernel_xs(x));
+      }
+    }
   }
 
   auto kernel_init() -> void {
     const auto size = x_.size();
+    if constexpr (kMetric) {
+      kernel_block(s_.data(), norms_.data(), size, k_);
+      for (size_t i = 0; i < size; ++i) {
+        k_[i][i] = k_func_(x_[i], x_[i]) + k_noise_ + e_[i];
+      }
+      return;
+    }
     k_.resize(size);
     for (size_t i = 0; i < size; ++i) {
       k_[i].resize(size);
       for (size_t j = 0; j < size; ++j) {
         if (i == j) {
-          k_[i][j] = k_func_(x_[i], x_[j]) + k_noise_;
+          k_[i][j] =
+              k_func_(x_[i], x_[j]) + k_noise_ + e_[i];
         } else {
           k_[i][j] = k_func_(x_[i], x_[j]);
         }
@@ -153,6 +462,17 @@ class process {
 
   auto kernel_update(const Input<Number>& x) -> void {
     const auto size = k_.size();
+    if constexpr (kMetric) {
+      auto row = Matrix<Number>{};
+      kernel_block(
+          &s_[size * Dimension], &norms_[size], 1, row);
+      row[0][size] = k_func_(x, x) + k_noise_ + e_[size];
+      for (size_t i = 0; i < size; ++i) {
+        k_[i].emplace_back(row[0][i]);
+      }
+      k_.emplace_back(std::move(row[0]));
+      return;
+    }
     for (size_t i = 0; i < size; ++i) {
       k_[i].emplace_back(k_func_(x_[i], x));
     }
@@ -160,7 +480,7 @@ class process {
     for (size_t j = 0; j < size; ++j) {
       k_.back()[j] = k_func_(x, x_[j]);
     }
-    k_.back()[size] = k_func_(x, x) + k_noise_;
+    k_.back()[size] = k_func_(x, x) + k_noise_ + e_[size];
   }
 
   template <class NumberLike>
@@ -207,46 +527,56 @@ class process {
   }
 
   auto solve_full() -> void {
-    const auto solver = Solver{};
-    solver.build(k_, l_);
-    solver.forward(l_, y_, z_);
-    solver.backward(l_, z_, a_);
+    solver_.build(k_, k_noise_);
+    solver_.solve(k_, y_, a_);
   }
 
   auto solve_last() -> void {
-    const auto solver = Solver{};
-    solver.build(k_, l_, l_.size());
-    solver.forward(l_, y_, z_, z_.size());
-    solver.backward(l_, z_, a_);
+    solver_.update(k_, k_noise_);
+    solver_.solve(k_, y_, a_);
   }
 
  private:
   Kernel k_func_;
   Number k_noise_;
+  Solver solver_;
   Matrix<Number> k_;
-  Matrix<Number> l_;
-  Vector<Number> z_;
   Vector<Number> a_;
   Inputs<Number> x_;
   Vector<Number> y_;
+  Vector<Number> e_;  ///< Extra noise variances
+  Vector<Number> s_;
+  Vector<Number> norms_;
 };
 
-template <std::size_t Dimension, class Kernel>
+// The solver policy is a template of the number type,
+// e.g. make_process<2, math::iterative>(kernel)
+template <
+    std::size_t Dimension,
+    template <class...> class Solver = math::direct,
+    class Kernel>
 inline auto make_process(const Kernel& kernel) {
   using Number = typename Kernel::number_t;
-  return process<Kernel, Number, Dimension>{
+  return process<Kernel, Number, Dimension, Solver<Number>>{
       kernel, {}, Number{0.0}};
 }
 
-template <std::size_t Dimension, class Kernel, class Number>
+template <
+    std::size_t Dimension,
+    template <class...> class Solver = math::direct,
+    class Kernel,
+    class Number>
 inline auto make_process(
     const Kernel& kernel,  //
     const Number& noise) {
-  return process<Kernel, Number, Dimension>{
+  return process<Kernel, Number, Dimension, Solver<Number>>{
       kernel, {}, noise};
 }
 
-template <class Kernel, class Dataset>
+template <
+    template <class...> class Solver = math::direct,
+    class Kernel,
+    class Dataset>
 inline auto make_process(
     const Kernel& kernel,  //
     const Dataset& dataset) {
@@ -256,11 +586,18 @@ inline auto make_process(
   using DNumber = typename DInput::value_type;
   static_assert(std::is_same_v<KNumber, DNumber>);
   constexpr auto Dimension = std::tuple_size_v<DInput>;
-  return process<Kernel, DNumber, Dimension>{
-      kernel, dataset, DNumber{0}};
+  return process<
+      Kernel,
+      DNumber,
+      Dimension,
+      Solver<DNumber>>{kernel, dataset, DNumber{0}};
 }
 
-template <class Kernel, class Dataset, class Number>
+template <
+    template <class...> class Solver = math::direct,
+    class Kernel,
+    class Dataset,
+    class Number>
 inline auto make_process(
     const Kernel& kernel,    //
     const Dataset& dataset,  //
@@ -272,7 +609,7 @@ inline auto make_process(
   static_assert(std::is_same_v<Number, KNumber>);
   static_assert(std::is_same_v<Number, DNumber>);
   constexpr auto Dimension = std::tuple_size_v<DInput>;
-  return process<Kernel, Number, Dimension>{
+  return process<Kernel, Number, Dimension, Solver<Number>>{
       kernel, dataset, noise};
 }
 
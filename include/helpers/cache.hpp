@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace b2o {
+
+/// @brief Evaluation cache on a hashed grid
+///
+/// Finds an evaluated sample within `tolerance` (max norm)
+/// of an input. Samples are bucketed by the hash of their
+/// grid cell, the cells being w = 2 D tolerance wide, so a
+/// query probes its own cell plus the neighbours of the
+/// dimensions where it lies within tolerance of a cell
+/// border: (1 + 1 / D)^D < e cells on average, whatever the
+/// dimension. A tolerance of zero disables the lookups
+/// (samples are still kept for a later reset).
+/// @tparam Input Input type (std::array)
+/// @tparam Number Numeric type
+template <class Input, class Number>
+class cache {
+  using Cell = std::vector<std::int64_t>;
+
+  static constexpr auto kLargestCell =
+      std::int64_t{1} << 62;
+
+ public:
+  using sample_t = std::pair<Input, Number>;
+
+  explicit cache(Number tolerance = Number{0}) {
+    reset(tolerance);
+  }
+
+  /// @brief Change the tolerance, samples are rehashed
+  auto reset(Number tolerance) -> void {
+    constexpr auto dimension = std::max(
+        std::tuple_size_v<Input>, std::size_t{1});
+    tolerance_ = std::max(tolerance, Number{0});
+    width_ = Number{2} * tolerance_ *
+             static_cast<Number>(dimension);
+    buckets_.clear();
+    for (std::size_t i = 0; i < samples_.size(); ++i) {
+      bucket(i);
+    }
+  }
+
+  auto tolerance() const -> Number {
+    return tolerance_;
+  }
+
+  auto size() const -> std::size_t {
+    return samples_.size();
+  }
+
+  /// @brief Inserted samples, in insertion order
+  auto samples() const -> const std::vector<sample_t>& {
+    return samples_;
+  }
+
+  auto insert(const Input& x, Number y) -> void {
+    samples_.emplace_back(x, y);
+    bucket(samples_.size() - 1);
+  }
+
+  /// @brief Sample within tolerance of x, nullptr if none
+  auto find(const Input& x) const -> const sample_t* {
+    if (!(tolerance_ > Number{0})) {
+      return nullptr;
+    }
+    const auto base = cell(x);
+    // neighbour direction per dimension, 0 if not needed
+    auto side = std::vector<int>(base.size());
+    auto near = std::vector<std::size_t>{};
+    for (std::size_t d = 0; d < base.size(); ++d) {
+      const auto offset =
+          x[d] - static_cast<Number>(base[d]) * width_;
+      if (offset < tolerance_) {
+        side[d] = -1;
+      } else if (offset > width_ - tolerance_) {
+        side[d] = 1;
+      }
+      if (side[d] != 0) {
+        near.push_back(d);
+      }
+    }
+    // every subset of the neighbour directions
+    auto probe = base;
+    const auto probes = std::size_t{1} << near.size();
+    for (std::size_t mask = 0; mask < probes; ++mask) {
+      for (std::size_t k = 0; k < near.size(); ++k) {
+        const auto d = near[k];
+        const auto step = ((mask >> k) & 1) ? side[d] : 0;
+        probe[d] = base[d] + step;
+      }
+      const auto it = buckets_.find(hash(probe));
+      if (it == std::end(buckets_)) {
+        continue;
+      }
+      for (const auto i : it->second) {
+        if (close(samples_[i].first, x)) {
+          return &samples_[i];
+        }
+      }
+    }
+    return nullptr;
+  }
+
+ protected:
+  auto bucket(std::size_t i) -> void {
+    if (tolerance_ > Number{0}) {
+      buckets_[hash(cell(samples_[i].first))].push_back(i);
+    }
+  }
+
+  // Quotients past +-kLargestCell (tiny widths, large |x|)
+  // share the outermost cells and NaN the cell 0, so the
+  // conversion (and a neighbour step) stays in range
+  auto cell(const Input& x) const -> Cell {
+    constexpr auto largest =
+        static_cast<Number>(kLargestCell);
+    auto result = Cell(x.size());
+    for (std::size_t d = 0; d < x.size(); ++d) {
+      const auto q = std::floor(x[d] / width_);
+      if (!std::isnan(q)) {
+        result[d] = static_cast<std::int64_t>(
+            std::clamp(q, -largest, largest));
+      }
+    }
+    return result;
+  }
+
+  static auto hash(const Cell& c) -> std::size_t {
+    auto seed = c.size();
+    for (const auto v : c) {
+      seed ^= std::hash<std::int64_t>{}(v) + 0x9e3779b9 +
+              (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+
+  auto close(const Input& a, const Input& b) const -> bool {
+    for (std::size_t d = 0; d < a.size(); ++d) {
+      if (!(std::abs(a[d] - b[d]) <= tolerance_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  Number tolerance_{0};
+  Number width_{0};
+  std::vector<sample_t> samples_;
+  std::unordered_map<std::size_t, std::vector<std::size_t>>
+      buckets_;
+};
+
+}  // namespace b2o
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace b2o {
+
+/// @brief Wall clock stopwatch (steady clock)
+class stopwatch {
+ public:
+  using clock_t = std::chrono::steady_clock;
+
+  stopwatch() : start_{clock_t::now()} {
+  }
+
+  /// @brief Restart the measure
+  auto reset() -> void {
+    start_ = clock_t::now();
+  }
+
+  /// @brief Seconds since construction or the last reset
+  auto elapsed() const -> double {
+    const auto span = clock_t::now() - start_;
+    return std::chrono::duration<double>(span).count();
+  }
+
+ private:
+  clock_t::time_point start_;
+};
+
+/// @brief Point in time after which anytime loops stop
+/// and return their best so far (never by default)
+class deadline {
+ public:
+  using clock_t = std::chrono::steady_clock;
+
+  deadline() = default;
+
+  /// @brief Expire in the given seconds from now
+  explicit deadline(double seconds) {
+    if (std::isfinite(seconds)) {
+      const auto span = std::chrono::duration<double>(
+          std::max(seconds, 0.0));
+      at_ = clock_t::now() +
+            std::chrono::duration_cast<clock_t::duration>(
+                span);
+    }
+  }
+
+  auto expired() const -> bool {
+    return at_ != clock_t::time_point::max() &&
+           clock_t::now() >= at_;
+  }
+
+  /// @brief The earlier of two deadlines
+  static auto min(const deadline& a, const deadline& b)
+      -> deadline {
+    return (a.at_ < b.at_) ? a : b;
+  }
+
+ private:
+  clock_t::time_point at_{clock_t::time_point::max()};
+};
+
+/// @brief Latency samples (seconds) and their quantiles
+/// over the last `window` ones (a ring, fixed memory)
+class latency {
+  static constexpr auto kWindow = std::size_t{1024};
+
+ public:
+  explicit latency(std::size_t window = kWindow)
+      : window_{std::max(window, std::size_t{1})} {
+    samples_.reserve(window_);
+  }
+
+  auto record(double seconds) -> void {
+    if (samples_.size() < window_) {
+      samples_.emplace_back(seconds);
+    } else {
+      samples_[count_ % window_] = seconds;
+    }
+    ++count_;
+  }
+
+  /// @brief Samples recorded in total
+  auto count() const -> std::size_t {
+    return count_;
+  }
+
+  /// @brief Nearest rank q-quantile, 0 when empty
+  auto quantile(double q) const -> double {
+    if (samples_.empty()) {
+      return 0.0;
+    }
+    auto sorted = samples_;
+    const auto rank = static_cast<std::size_t>(std::ceil(
+        std::clamp(q, 0.0, 1.0) * sorted.size()));
+    const auto k = std::max(rank, std::size_t{1}) - 1;
+    std::nth_element(
+        std::begin(sorted),
+        std::begin(sorted) + k,
+        std::end(sorted));
+    return sorted[k];
+  }
+
+  auto p50() const -> double {
+    return quantile(0.50);
+  }
+
+  auto p99() const -> double {
+    return quantile(0.99);
+  }
+
+ private:
+  std::size_t window_;
+  std::size_t count_{0};
+  std::vector<double> samples_;
+};
+
+}  // namespace b2o
@@ -4,13 +4,18 @@
 #include <sstream>
 #include <string>
 
+// Sample observer of 2D problems (helpers/logging.hpp),
+// opt-in: writes the samples, the model and the
+// acquisition over a grid as JSON, e.g.
+//   make_optimizer<2>()...build<EI, gradient, debug_3d>()
 class debug_3d final {
   static constexpr auto kMin = -5.0;
   static constexpr auto kMax = 15.0;
   static constexpr auto kStp = 1.0;
 
  public:
-  debug_3d(std::string path) : os_{path} {
+  debug_3d(std::string path = "./bayesian_debug.json")
+      : os_{path} {
     os_ << "[" << std::endl;
   }
 
@@ -19,6 +24,16 @@ class debug_3d final {
     os_ << std::endl << "]" << std::endl;
   }
 
+  template <class S, class M>
+  auto sample(const S& s, const M& m) {
+    print(s, m);
+  }
+
+  template <class S, class M, class A>
+  auto sample(const S& s, const M& m, const A& a) {
+    print(s, m, a);
+  }
+
   template <class S, class M>
   auto print(const S& s, const M& m) {
     os_ << "{ " << std::endl;
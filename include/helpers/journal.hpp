@@ -0,0 +1,230 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace b2o {
+
+/// @brief Append-only evaluation journal
+///
+/// Binary file of fixed size records (x, y, cost) after an
+/// 8 byte magic and the record size. Appends are buffered
+/// and written with one fsync every `batch` records (and on
+/// flush() or destruction), so a crash loses at most the
+/// unflushed ones. Opening an existing journal recovers its
+/// records and drops a torn last one. A file that cannot be
+/// opened, or a non-empty file that is not a journal of
+/// this layout (dimension, number type, left untouched),
+/// throws std::system_error.
+/// A failed write keeps its records buffered for the next
+/// flush and good() false until then. Default constructed:
+/// closed, appends are ignored.
+/// @tparam Input Trivially copyable input (std::array)
+/// @tparam Number Numeric type
+template <class Input, class Number>
+class journal {
+  static_assert(std::is_trivially_copyable_v<Input>);
+  static_assert(std::is_trivially_copyable_v<Number>);
+
+  static constexpr char kMagic[8] = {
+      'b', '2', 'o', 'j', 'r', 'n', 'l', '1'};
+  static constexpr auto kRecord =
+      std::uint32_t{sizeof(Input) + 2 * sizeof(Number)};
+  static constexpr auto kHeader =
+      sizeof(kMagic) + sizeof(kRecord);
+  static constexpr auto kBatch = std::size_t{8};
+
+ public:
+  struct record_t {
+    Input x;
+    Number y;
+    Number cost;
+  };
+
+  journal() = default;
+
+  /// @brief Open (or create) a journal for appending
+  /// @param path File path
+  /// @param batch Records per fsync (at least one)
+  /// @throw std::system_error if it cannot be opened
+  explicit journal(
+      const std::string& path, std::size_t batch = kBatch)
+      : batch_{std::max(batch, std::size_t{1})} {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0 || !recover()) {
+      const auto error = errno;
+      if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+      }
+      throw std::system_error{
+          error, std::generic_category(), path};
+    }
+  }
+
+  journal(journal&& other) noexcept {
+    swap(other);
+  }
+
+  auto operator=(journal&& other) noexcept -> journal& {
+    swap(other);
+    return *this;
+  }
+
+  ~journal() {
+    if (fd_ >= 0) {
+      flush();
+      ::close(fd_);
+    }
+  }
+
+  auto is_open() const -> bool {
+    return fd_ >= 0;
+  }
+
+  /// @brief Whether the last write reached the disk
+  auto good() const -> bool {
+    return good_;
+  }
+
+  /// @brief Records found on open (moved out)
+  auto recovered() -> std::vector<record_t> {
+    return std::move(recovered_);
+  }
+
+  auto append(const Input& x, Number y, Number cost)
+      -> void {
+    if (fd_ < 0) {
+      return;
+    }
+    const auto size = buffer_.size();
+    buffer_.resize(size + kRecord);
+    auto* p = buffer_.data() + size;
+    std::memcpy(p, &x, sizeof(Input));
+    std::memcpy(p + sizeof(Input), &y, sizeof(Number));
+    std::memcpy(
+        p + sizeof(Input) + sizeof(Number),
+        &cost,
+        sizeof(Number));
+    if (buffer_.size() >= batch_ * kRecord) {
+      flush();
+    }
+  }
+
+  /// @brief Write the buffered records and fsync
+  /// @return false on I/O errors (records kept buffered,
+  /// a partial write is cut so the retry stays aligned)
+  auto flush() -> bool {
+    if (fd_ < 0 || buffer_.empty()) {
+      return good_;
+    }
+    const auto end = ::lseek(fd_, 0, SEEK_END);
+    if (end < 0 || !write(buffer_.data(), buffer_.size())) {
+      if (end >= 0 && ::ftruncate(fd_, end) == 0) {
+        ::lseek(fd_, end, SEEK_SET);
+      }
+      return good_ = false;
+    }
+    buffer_.clear();
+    return good_ = ::fsync(fd_) == 0;
+  }
+
+ protected:
+  // Write the header of an empty file, or validate it, read
+  // the records and cut a torn tail so appends stay aligned
+  auto recover() -> bool {
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+      return false;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+      char header[kHeader];
+      std::memcpy(header, kMagic, sizeof(kMagic));
+      std::memcpy(
+          header + sizeof(kMagic),
+          &kRecord,
+          sizeof(kRecord));
+      return write(header, kHeader) && ::fsync(fd_) == 0;
+    }
+    if (size < kHeader) {
+      errno = EINVAL;
+      return false;
+    }
+    auto data = std::vector<char>(size);
+    const auto bytes = ::pread(fd_, data.data(), size, 0);
+    if (bytes != static_cast<ssize_t>(size)) {
+      errno = bytes < 0 ? errno : EIO;
+      return false;
+    }
+    auto record = std::uint32_t{0};
+    std::memcpy(
+        &record,
+        data.data() + sizeof(kMagic),
+        sizeof(record));
+    if (std::memcmp(data.data(), kMagic, sizeof(kMagic)) !=
+            0 ||
+        record != kRecord) {
+      errno = EINVAL;
+      return false;
+    }
+    const auto n = (size - kHeader) / kRecord;
+    recovered_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto* p = data.data() + kHeader + i * kRecord;
+      auto& r = recovered_[i];
+      std::memcpy(&r.x, p, sizeof(Input));
+      std::memcpy(&r.y, p + sizeof(Input), sizeof(Number));
+      std::memcpy(
+          &r.cost,
+          p + sizeof(Input) + sizeof(Number),
+          sizeof(Number));
+    }
+    const auto end = kHeader + n * kRecord;
+    return (end == size ||
+            ::ftruncate(fd_, static_cast<off_t>(end)) ==
+                0) &&
+           ::lseek(fd_, 0, SEEK_END) >= 0;
+  }
+
+  auto write(const char* data, std::size_t size) -> bool {
+    while (size > 0) {
+      const auto n = ::write(fd_, data, size);
+      if (n < 0) {
+        return false;
+      }
+      data += n;
+      size -= static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+
+  auto swap(journal& other) noexcept -> void {
+    std::swap(fd_, other.fd_);
+    std::swap(batch_, other.batch_);
+    std::swap(good_, other.good_);
+    std::swap(buffer_, other.buffer_);
+    std::swap(recovered_, other.recovered_);
+  }
+
+ private:
+  int fd_{-1};
+  std::size_t batch_{kBatch};
+  bool good_{true};
+  std::vector<char> buffer_;
+  std::vector<record_t> recovered_;
+};
+
+}  // namespace b2o
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace b2o::logging {
+
+/// @brief Observer policies
+///
+/// Optimizers report through an Observer template parameter:
+///
+///   number(name, value)    a scalar (iteration, objective)
+///   vector(name, values)   a container (input, gradient)
+///   sample(s, model[, a])  an evaluated sample (x, y), the
+///                          model and the acquisition
+///
+/// none is the default and compiles away. The sinks keep
+/// the events in memory and write them on flush() or on
+/// destruction, never from the hot loop: buffered as text
+/// lines, structured as one JSON object per line. Sinks
+/// may be shared by concurrent optimizer runs.
+struct none {
+  template <class T>
+  auto number(const char*, const T&) const -> void {
+  }
+
+  template <class T>
+  auto vector(const char*, const T&) const -> void {
+  }
+
+  template <class... Ts>
+  auto sample(const Ts&...) const -> void {
+  }
+};
+
+namespace detail {
+
+/// @brief In-memory buffer in front of an output stream
+class sink {
+ public:
+  explicit sink(std::ostream& os) : os_{os} {
+  }
+
+  sink(const sink&) = delete;
+  auto operator=(const sink&) -> sink& = delete;
+
+  ~sink() {
+    flush();
+  }
+
+  /// @brief Write out the buffered events
+  auto flush() const -> void {
+    const auto lock = std::lock_guard{mutex_};
+    os_ << buffer_.str();
+    os_.flush();
+    buffer_.str({});
+  }
+
+  /// @brief Buffered events not yet written out
+  auto str() const -> std::string {
+    const auto lock = std::lock_guard{mutex_};
+    return buffer_.str();
+  }
+
+ protected:
+  /// @brief Append one event, fn(os) formats it
+  template <class Fn>
+  auto write(Fn fn) const -> void {
+    const auto lock = std::lock_guard{mutex_};
+    fn(buffer_);
+  }
+
+ private:
+  std::ostream& os_;
+  mutable std::mutex mutex_;
+  mutable std::ostringstream buffer_;
+};
+
+}  // namespace detail
+
+/// @brief Text lines, "name = value" and
+/// "name = [ v1 v2 ... ]"
+class buffered : public detail::sink {
+ public:
+  explicit buffered(std::ostream& os = std::cout)
+      : sink{os} {
+  }
+
+  template <class T>
+  auto number(const char* name, const T& value) const
+      -> void {
+    write([&](auto& os) {
+      os << name << " = " << value << '\n';
+    });
+  }
+
+  template <class T>
+  auto vector(const char* name, const T& values) const
+      -> void {
+    write([&](auto& os) {
+      os << name << " = [";
+      for (const auto& v : values) {
+        os << ' ' << v;
+      }
+      os << " ]\n";
+    });
+  }
+
+  template <class Sample, class... Ts>
+  auto sample(const Sample& s, const Ts&...) const -> void {
+    const auto& [x, y] = s;
+    vector("x", x);
+    number("y", y);
+  }
+};
+
+/// @brief JSON lines, {"name": ..., "value": ...} and
+/// {"x": [...], "y": ...} for samples
+class structured : public detail::sink {
+ public:
+  explicit structured(std::ostream& os = std::cout)
+      : sink{os} {
+  }
+
+  template <class T>
+  auto number(const char* name, const T& value) const
+      -> void {
+    write([&](auto& os) {
+      os << "{\"name\": \"" << name
+         << "\", \"value\": " << value << "}\n";
+    });
+  }
+
+  template <class T>
+  auto vector(const char* name, const T& values) const
+      -> void {
+    write([&](auto& os) {
+      os << "{\"name\": \"" << name << "\", \"value\": ";
+      array(os, values);
+      os << "}\n";
+    });
+  }
+
+  template <class Sample, class... Ts>
+  auto sample(const Sample& s, const Ts&...) const -> void {
+    const auto& [x, y] = s;
+    write([&](auto& os) {
+      os << "{\"x\": ";
+      array(os, x);
+      os << ", \"y\": " << y << "}\n";
+    });
+  }
+
+ protected:
+  template <class Stream, class T>
+  static auto array(Stream& os, const T& values) -> void {
+    auto separator = "";
+    os << '[';
+    for (const auto& v : values) {
+      os << separator << v;
+      separator = ", ";
+    }
+    os << ']';
+  }
+};
+
+}  // namespace b2o::logging
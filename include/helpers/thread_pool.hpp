@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace b2o {
+
+/// @brief Work-stealing thread pool
+///
+/// Every worker owns a deque: it pushes and pops its own
+/// tasks at the back and steals from the front of the
+/// others when idle. Threads outside the pool submit
+/// round-robin and may help draining the queues while
+/// they wait, so nested waits never deadlock. The count of
+/// pending tasks is atomic: the pool mutex is only taken
+/// to put idle workers to sleep and to wake them.
+class thread_pool {
+ public:
+  using task_t = std::function<void()>;
+
+  explicit thread_pool(std::size_t workers = cores())
+      : queues_(std::max<std::size_t>(workers, 1)) {
+    for (auto& queue : queues_) {
+      queue = std::make_unique<queue_t>();
+    }
+    threads_.reserve(workers);
+    for (std::size_t w = 0; w < workers; ++w) {
+      threads_.emplace_back([this, w] { work(w); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  auto operator=(const thread_pool&) -> thread_pool& = delete;
+
+  ~thread_pool() {
+    {
+      const auto lock = std::lock_guard{mutex_};
+      stop_ = true;
+    }
+    idle_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  /// @brief Process wide pool sized to the hardware
+  static auto instance() -> thread_pool& {
+    static auto pool = thread_pool{};
+    return pool;
+  }
+
+  /// @brief Number of worker threads
+  auto size() const -> std::size_t {
+    return threads_.size();
+  }
+
+  /// @brief Enqueue a task
+  /// @param task Callable run exactly once by some thread
+  auto submit(task_t task) -> void {
+    const auto slot = (owner_ == this)
+                          ? index_
+                          : next_++ % queues_.size();
+    pending_.fetch_add(1);
+    {
+      auto& queue = *queues_[slot];
+      const auto lock = std::lock_guard{queue.mutex};
+      queue.tasks.emplace_back(std::move(task));
+    }
+    // a sleeper checked pending_ under the mutex, passing
+    // through it orders the notify after its wait
+    if (sleeping_.load() > 0) {
+      {
+        const auto lock = std::lock_guard{mutex_};
+      }
+      idle_.notify_one();
+    }
+  }
+
+  /// @brief Run one pending task on the calling thread
+  /// @return False when there was nothing to run
+  auto try_run() -> bool {
+    const auto start = (owner_ == this) ? index_ : 0;
+    auto task = take(start);
+    if (!task) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+  /// @brief Help draining tasks until done() holds
+  /// @param done Completion predicate (thread safe)
+  template <class Done>
+  auto wait(Done done) -> void {
+    while (!done()) {
+      if (!try_run()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /// @brief Run fn(i) for i in [0, n) across the pool
+  /// @param n Number of iterations
+  /// @param fn Callable, invoked concurrently
+  template <class Fn>
+  auto parallel_for(std::size_t n, Fn fn) -> void {
+    const auto chunks = std::min(n, 4 * (size() + 1));
+    if (chunks < 2) {
+      for (std::size_t i = 0; i < n; ++i) {
+        fn(i);
+      }
+      return;
+    }
+    auto done = std::atomic<std::size_t>{0};
+    for (std::size_t c = 0; c < chunks; ++c) {
+      submit([&, c] {
+        const auto beg = n * c / chunks;
+        const auto end = n * (c + 1) / chunks;
+        for (auto i = beg; i < end; ++i) {
+          fn(i);
+        }
+        done.fetch_add(1, std::memory_order_release);
+      });
+    }
+    wait([&] {
+      return done.load(std::memory_order_acquire) ==
+             chunks;
+    });
+  }
+
+ protected:
+  struct queue_t {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  static auto cores() -> std::size_t {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  auto take(std::size_t start) -> task_t {
+    const auto n = queues_.size();
+    for (std::size_t q = 0; q < n; ++q) {
+      auto& queue = *queues_[(start + q) % n];
+      const auto lock = std::lock_guard{queue.mutex};
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      // owner pops LIFO, thieves steal FIFO
+      auto task = task_t{};
+      if (q == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      pending_.fetch_sub(1);
+      return task;
+    }
+    return {};
+  }
+
+  auto work(std::size_t index) -> void {
+    owner_ = this;
+    index_ = index;
+    for (;;) {
+      if (auto task = take(index)) {
+        task();
+        continue;
+      }
+      auto lock = std::unique_lock{mutex_};
+      sleeping_.fetch_add(1);
+      idle_.wait(lock, [this] {
+        return stop_ || pending_.load() > 0;
+      });
+      sleeping_.fetch_sub(1);
+      if (stop_ && pending_.load() == 0) {
+        return;
+      }
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<queue_t>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_{0};
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> sleeping_{0};
+  bool stop_{false};  ///< Guarded by mutex_
+
+  static inline thread_local thread_pool* owner_{nullptr};
+  static inline thread_local std::size_t index_{0};
+};
+
+}  // namespace b2o
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+#include "kernel/metric.hpp"
+
+namespace b2o::kernel {
+
+// @brief Kernel algebra
+//
+// Kernels compose into a single expression type:
+//
+//   radial{l1} + matern52{l2} * scale{s}
+//     -> sum<radial, product<matern52, scale>> ,
+//
+//   sum      k(x, y) = a(x, y) + b(x, y) ,
+//   product  k(x, y) = a(x, y) * b(x, y) ,
+//   scale    k(x, y) = s (constant, amplitude factor) .
+//
+// A term is a stationary kernel (one metric) or a scale
+// (none). Every term exposes
+//
+//   metrics           number of metrics below it ,
+//   each_metric(f)    f(m) for those, left to right ,
+//   fold<I>(r2)       its value from the distances r2,
+//                     its first metric being r2[I] .
+//
+// Evaluation computes r2 once per distinct metric: terms
+// whose metric equals an earlier one (same type and length
+// scales, checked on construction) reuse its r2. The rest
+// of the expression inlines into one function, for plain
+// and dual numbers alike.
+//
+// Spectral samples (gaussian/path.hpp) compose too, with
+// variance() = k(x, x):
+//
+//   sum      a draw of a or b, in proportion to variances ,
+//   product  the sum of a draw of a and one of b ,
+//   scale    zero (constant) .
+//
+template <class Number>
+class scale {
+ public:
+  using number_t = Number;
+
+  static constexpr auto metrics = std::size_t{0};
+
+  explicit scale(const Number& value) : value_{value} {
+  }
+
+  template <class SampleX, class SampleY>
+  auto operator()(const SampleX&, const SampleY&) const
+      -> Number {
+    return value_;
+  }
+
+  template <class Visitor>
+  auto each_metric(Visitor&&) const -> void {
+  }
+
+  template <std::size_t I, class Distances>
+  auto fold(const Distances&) const -> Number {
+    return value_;
+  }
+
+  auto variance() const -> Number {
+    return value_;
+  }
+
+  template <std::size_t N, class Rng>
+  auto spectral(Rng&) const -> std::array<Number, N> {
+    return {};
+  }
+
+ private:
+  Number value_;
+};
+
+namespace detail {
+
+template <class Derived, class A, class B>
+class expression {
+ public:
+  using number_t = typename A::number_t;
+
+  static constexpr auto metrics = A::metrics + B::metrics;
+
+  expression(const A& a, const B& b)
+      : a_{a}, b_{b}, owner_{owners()} {
+  }
+
+  template <class SampleX, class SampleY>
+  auto operator()(
+      const SampleX& x,  //
+      const SampleY& y) const {
+    using Distance = std::decay_t<decltype(
+        std::get<0>(x) - std::get<0>(y))>;
+    auto r2 = std::array<Distance, metrics>{};
+    auto i = std::size_t{0};
+    each_metric([&](const auto& m) {
+      if (owner_[i] == i) {
+        r2[i] = m.distance(x, y);
+      } else {
+        r2[i] = r2[owner_[i]];
+      }
+      ++i;
+    });
+    return self().template fold<0>(r2);
+  }
+
+  template <class Visitor>
+  auto each_metric(Visitor&& visit) const -> void {
+    a_.each_metric(visit);
+    b_.each_metric(visit);
+  }
+
+ protected:
+  auto self() const -> const Derived& {
+    return static_cast<const Derived&>(*this);
+  }
+
+  // owner[i] = first metric equal to metric i
+  auto owners() const -> std::array<std::size_t, metrics> {
+    auto owner = std::array<std::size_t, metrics>{};
+    auto i = std::size_t{0};
+    each_metric([&](const auto& mi) {
+      owner[i] = i;
+      auto j = std::size_t{0};
+      each_metric([&](const auto& mj) {
+        if (j < i && owner[i] == i && shares(mj, mi)) {
+          owner[i] = j;
+        }
+        ++j;
+      });
+      ++i;
+    });
+    return owner;
+  }
+
+  A a_;
+  B b_;
+  std::array<std::size_t, metrics> owner_;
+};
+
+template <class T, class = void>
+struct is_term : std::false_type {};
+
+template <class T>
+struct is_term<T, std::void_t<decltype(T::metrics)>>
+    : std::true_type {};
+
+template <class A, class B>
+using enable_terms_t = std::enable_if_t<
+    is_term<A>::value && is_term<B>::value,
+    int>;
+
+}  // namespace detail
+
+template <class A, class B>
+class sum : public detail::expression<sum<A, B>, A, B> {
+  using Base = detail::expression<sum<A, B>, A, B>;
+
+ public:
+  using Base::Base;
+
+  template <std::size_t I, class Distances>
+  auto fold(const Distances& r2) const {
+    return this->a_.template fold<I>(r2) +
+           this->b_.template fold<I + A::metrics>(r2);
+  }
+
+  auto variance() const {
+    return this->a_.variance() + this->b_.variance();
+  }
+
+  template <std::size_t N, class Rng>
+  auto spectral(Rng& rng) const {
+    using Number = typename Base::number_t;
+    const auto va = this->a_.variance();
+    auto pick = std::uniform_real_distribution<Number>{
+        Number{0}, variance()};
+    if (pick(rng) < va) {
+      return this->a_.template spectral<N>(rng);
+    }
+    return this->b_.template spectral<N>(rng);
+  }
+};
+
+template <class A, class B>
+class product
+    : public detail::expression<product<A, B>, A, B> {
+  using Base = detail::expression<product<A, B>, A, B>;
+
+ public:
+  using Base::Base;
+
+  template <std::size_t I, class Distances>
+  auto fold(const Distances& r2) const {
+    return this->a_.template fold<I>(r2) *
+           this->b_.template fold<I + A::metrics>(r2);
+  }
+
+  auto variance() const {
+    return this->a_.variance() * this->b_.variance();
+  }
+
+  template <std::size_t N, class Rng>
+  auto spectral(Rng& rng) const {
+    auto omega = this->a_.template spectral<N>(rng);
+    const auto other = this->b_.template spectral<N>(rng);
+    for (std::size_t d = 0; d < N; ++d) {
+      omega[d] += other[d];
+    }
+    return omega;
+  }
+};
+
+template <
+    class A,
+    class B,
+    detail::enable_terms_t<A, B> = 0>
+inline auto operator+(const A& a, const B& b) {
+  return sum<A, B>{a, b};
+}
+
+template <
+    class A,
+    class B,
+    detail::enable_terms_t<A, B> = 0>
+inline auto operator*(const A& a, const B& b) {
+  return product<A, B>{a, b};
+}
+
+}  // namespace b2o::kernel
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include "kernel/metric.hpp"
+#include "math/policy.hpp"
+
+namespace b2o::kernel {
+namespace detail {
+
+// r = sqrt(r2), safe for dual numbers: the derivative of
+// sqrt is infinite at 0 while r2 is flat there, so r2 is
+// passed through (Matern 3/2 and 5/2 are flat at r = 0)
+template <class Number, class Distance>
+inline auto root(const Distance& r2) {
+  if (Number{0} < r2) {
+    return Distance{std::sqrt(r2)};
+  }
+  return r2;
+}
+
+// Spectral gain of Matern nu: its density is a Student t
+// with dof = 2 nu degrees of freedom, a normal scaled by
+// sqrt(dof / u) , u ~ chi2(dof)
+template <class Number, class Rng>
+inline auto student(Rng& rng, const Number& dof) -> Number {
+  auto chi2 = std::chi_squared_distribution<Number>{dof};
+  return std::sqrt(dof / chi2(rng));
+}
+
+}  // namespace detail
+
+// @brief Matern 1/2 kernel (exponential)
+//
+//   k(x, y) = exp(-r) ,  r = |(x - y) / sigma| .
+//
+template <class Sigma, class Math = math::standard>
+class matern12
+    : public detail::stationary<
+          matern12<Sigma, Math>,
+          Sigma> {
+  using Base =
+      detail::stationary<matern12<Sigma, Math>, Sigma>;
+
+ public:
+  using number_t = typename Base::number_t;
+
+  explicit matern12(const Sigma& sigma) : Base{sigma} {
+  }
+
+  template <class Distance>
+  auto evaluate(const Distance& r2) const {
+    return Math::exp(-detail::root<number_t>(r2));
+  }
+
+  auto profile(
+      const number_t* r2, number_t* k, size_t n) const
+      -> void {
+    for (size_t i = 0; i < n; ++i) {
+      k[i] = -std::sqrt(r2[i]);
+    }
+    Math::exp(k, k, n);
+  }
+
+  template <class Rng>
+  auto gain(Rng& rng) const -> number_t {
+    return detail::student(rng, number_t{1});
+  }
+};
+
+// @brief Matern 3/2 kernel
+//
+//   k(x, y) = (1 + a) exp(-a) ,  a = sqrt(3) r .
+//
+template <class Sigma, class Math = math::standard>
+class matern32
+    : public detail::stationary<
+          matern32<Sigma, Math>,
+          Sigma> {
+  using Base =
+      detail::stationary<matern32<Sigma, Math>, Sigma>;
+
+ public:
+  using number_t = typename Base::number_t;
+
+  explicit matern32(const Sigma& sigma) : Base{sigma} {
+  }
+
+  template <class Distance>
+  auto evaluate(const Distance& r2) const {
+    const auto a = sqrt_3 * detail::root<number_t>(r2);
+    return (number_t{1} + a) * Math::exp(-a);
+  }
+
+  auto profile(
+      const number_t* r2, number_t* k, size_t n) const
+      -> void {
+    for (size_t i = 0; i < n; ++i) {
+      k[i] = -sqrt_3 * std::sqrt(r2[i]);
+    }
+    Math::exp(k, k, n);
+    for (size_t i = 0; i < n; ++i) {
+      const auto a = sqrt_3 * std::sqrt(r2[i]);
+      k[i] = (number_t{1} + a) * k[i];
+    }
+  }
+
+  template <class Rng>
+  auto gain(Rng& rng) const -> number_t {
+    return detail::student(rng, number_t{3});
+  }
+
+ private:
+  static constexpr auto sqrt_3 =
+      number_t{1.73205080756887729352744634150587237L};
+};
+
+// @brief Matern 5/2 kernel
+//
+//   k(x, y) = (1 + a + a^2 / 3) exp(-a) ,  a = sqrt(5) r .
+//
+template <class Sigma, class Math = math::standard>
+class matern52
+    : public detail::stationary<
+          matern52<Sigma, Math>,
+          Sigma> {
+  using Base =
+      detail::stationary<matern52<Sigma, Math>, Sigma>;
+
+ public:
+  using number_t = typename Base::number_t;
+
+  explicit matern52(const Sigma& sigma) : Base{sigma} {
+  }
+
+  template <class Distance>
+  auto evaluate(const Distance& r2) const {
+    constexpr auto third = number_t{1} / number_t{3};
+    const auto a = sqrt_5 * detail::root<number_t>(r2);
+    return (number_t{1} + a + third * (a * a)) *
+           Math::exp(-a);
+  }
+
+  auto profile(
+      const number_t* r2, number_t* k, size_t n) const
+      -> void {
+    constexpr auto third = number_t{1} / number_t{3};
+    for (size_t i = 0; i < n; ++i) {
+      k[i] = -sqrt_5 * std::sqrt(r2[i]);
+    }
+    Math::exp(k, k, n);
+    for (size_t i = 0; i < n; ++i) {
+      const auto a = sqrt_5 * std::sqrt(r2[i]);
+      k[i] = (number_t{1} + a + third * (a * a)) * k[i];
+    }
+  }
+
+  template <class Rng>
+  auto gain(Rng& rng) const -> number_t {
+    return detail::student(rng, number_t{5});
+  }
+
+ private:
+  static constexpr auto sqrt_5 =
+      number_t{2.23606797749978969640917366873127624L};
+};
+
+}  // namespace b2o::kernel
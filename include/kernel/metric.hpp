@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <tuple>
+#include <utility>
+
+namespace b2o::kernel {
+
+// @brief Scaled squared distance of stationary kernels
+//
+//   r2(x, y) = sum_d ((x_d - y_d) / l_d)^2 ,
+//
+// with one length scale l (isotropic, Sigma = Number) or
+// one per dimension (ARD, Sigma = std::array<Number, N>).
+// Kernels built on the same metric can share r2, see
+// kernel/algebra.hpp.
+//
+// frequency<N>(rng, g) draws o_d = g * z_d / l_d with
+// z ~ N(0, I), the spectral samples of kernels in r2 (see
+// gaussian/path.hpp).
+//
+template <class Sigma>
+class metric {
+ public:
+  using number_t = Sigma;
+
+  explicit metric(const Sigma& length)
+      : length_{length},
+        inverse_{Sigma{1} / length},
+        inverse2_{inverse_ * inverse_} {
+    assert(length > Sigma{0});
+  }
+
+  template <class SampleX, class SampleY>
+  auto distance(const SampleX& x, const SampleY& y) const {
+    constexpr auto nx = std::tuple_size_v<SampleX>;
+    constexpr auto ny = std::tuple_size_v<SampleY>;
+    static_assert(nx == ny);
+    return accumulate(x, y, std::make_index_sequence<nx>{});
+  }
+
+  // x in units of the length scale
+  template <class Input>
+  auto scale(Input x) const -> Input {
+    for (auto& xi : x) {
+      xi = xi * inverse_;
+    }
+    return x;
+  }
+
+  auto length() const -> const Sigma& {
+    return length_;
+  }
+
+  template <std::size_t N, class Rng>
+  auto frequency(Rng& rng, const Sigma& gain) const
+      -> std::array<Sigma, N> {
+    auto normal = std::normal_distribution<Sigma>{};
+    auto omega = std::array<Sigma, N>{};
+    for (auto& o : omega) {
+      o = normal(rng) * gain * inverse_;
+    }
+    return omega;
+  }
+
+ protected:
+  template <class SampleX, class SampleY, size_t... I>
+  auto accumulate(
+      const SampleX& x,  //
+      const SampleY& y,  //
+      std::index_sequence<I...>) const {
+    return (([&] {
+      const auto delta = std::get<I>(x) - std::get<I>(y);
+      return delta * delta;
+    }() + ...)) * inverse2_;
+  }
+
+ private:
+  Sigma length_;
+  Sigma inverse_;
+  Sigma inverse2_;
+};
+
+template <class Number, std::size_t N>
+class metric<std::array<Number, N>> {
+  static constexpr auto invert = [](auto... length) {
+    ((assert(length > Number{0})), ...);
+    return std::array{(Number{1} / length)...};
+  };
+  static constexpr auto square = [](auto... inverse) {
+    return std::array{(inverse * inverse)...};
+  };
+
+ public:
+  using number_t = Number;
+
+  explicit metric(const std::array<Number, N>& length)
+      : length_{length},
+        inverse_{std::apply(invert, length)},
+        inverse2_{std::apply(square, inverse_)} {
+  }
+
+  template <class SampleX, class SampleY>
+  auto distance(const SampleX& x, const SampleY& y) const {
+    constexpr auto nx = std::tuple_size_v<SampleX>;
+    constexpr auto ny = std::tuple_size_v<SampleY>;
+    static_assert(nx == N, "dimension x mismatch");
+    static_assert(ny == N, "dimension y mismatch");
+    return accumulate(x, y, std::make_index_sequence<N>{});
+  }
+
+  // x in units of the length scales
+  template <class Input>
+  auto scale(Input x) const -> Input {
+    for (size_t i = 0; i < N; ++i) {
+      x[i] = x[i] * inverse_[i];
+    }
+    return x;
+  }
+
+  auto length() const -> const std::array<Number, N>& {
+    return length_;
+  }
+
+  template <std::size_t M, class Rng>
+  auto frequency(Rng& rng, const Number& gain) const
+      -> std::array<Number, M> {
+    static_assert(M == N, "dimension mismatch");
+    auto normal = std::normal_distribution<Number>{};
+    auto omega = std::array<Number, N>{};
+    for (size_t i = 0; i < N; ++i) {
+      omega[i] = normal(rng) * gain * inverse_[i];
+    }
+    return omega;
+  }
+
+ protected:
+  template <class SampleX, class SampleY, size_t... I>
+  auto accumulate(
+      const SampleX& x,  //
+      const SampleY& y,  //
+      std::index_sequence<I...>) const {
+    return ([&] {
+      const auto delta = std::get<I>(x) - std::get<I>(y);
+      return (delta * delta) * std::get<I>(inverse2_);
+    }() + ...);
+  }
+
+ private:
+  std::array<Number, N> length_;
+  std::array<Number, N> inverse_;
+  std::array<Number, N> inverse2_;
+};
+
+// Whether two metrics give the same r2 for every pair
+template <class SigmaA, class SigmaB>
+inline auto shares(
+    const metric<SigmaA>&, const metric<SigmaB>&) -> bool {
+  return false;
+}
+
+template <class Sigma>
+inline auto shares(
+    const metric<Sigma>& a,  //
+    const metric<Sigma>& b) -> bool {
+  return a.length() == b.length();
+}
+
+namespace detail {
+
+// @brief Stationary kernel k(x, y) = f(r2(x, y))
+//
+// Derived provides the profile f twice: evaluate(r2) on one
+// (plain or dual) number and profile(r2, k, n) over an
+// array, the latter used for blocks (kernel/traits.hpp).
+// The leaf interface of kernel/algebra.hpp (metrics,
+// each_metric, fold) is implemented here once.
+//
+// f(0) = 1, and Derived provides gain(rng) so that
+// spectral<N>(rng) samples the normalized spectral density
+// of k (Bochner): o = gain * z / l , z ~ N(0, I).
+//
+template <class Derived, class Sigma>
+class stationary : public metric<Sigma> {
+ public:
+  using metric_t = metric<Sigma>;
+  using number_t = typename metric_t::number_t;
+
+  static constexpr auto metrics = std::size_t{1};
+
+  explicit stationary(const Sigma& length)
+      : metric_t{length} {
+  }
+
+  template <class SampleX, class SampleY>
+  auto operator()(
+      const SampleX& x,  //
+      const SampleY& y) const {
+    return self().evaluate(this->distance(x, y));
+  }
+
+  template <class Visitor>
+  auto each_metric(Visitor&& visit) const -> void {
+    visit(static_cast<const metric_t&>(*this));
+  }
+
+  template <std::size_t I, class Distances>
+  auto fold(const Distances& r2) const {
+    return self().evaluate(std::get<I>(r2));
+  }
+
+  auto variance() const -> number_t {
+    return number_t{1};
+  }
+
+  template <std::size_t N, class Rng>
+  auto spectral(Rng& rng) const {
+    return this->template frequency<N>(
+        rng, self().gain(rng));
+  }
+
+ protected:
+  auto self() const -> const Derived& {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+}  // namespace detail
+}  // namespace b2o::kernel
@@ -1,93 +1,52 @@
 #pragma once
 
-#include <array>
-#include <cassert>
 #include <cstddef>
-#include <tuple>
+
+#include "kernel/metric.hpp"
+#include "math/policy.hpp"
 
 namespace b2o::kernel {
 
-template <class Number>
-class radial {
-  static constexpr auto two = Number{2.0};
-  static constexpr auto zero = Number{0.0};
+// @brief Radial basis function (squared exponential)
+//
+//   k(x, y) = exp(-r2 / 2) ,  r2 = |(x - y) / sigma|^2 ,
+//
+// isotropic (Sigma = Number) or ARD
+// (Sigma = std::array<Number, N>). Its spectral density is
+// N(0, 1 / sigma^2).
+//
+template <class Sigma, class Math = math::standard>
+class radial
+    : public detail::stationary<
+          radial<Sigma, Math>,
+          Sigma> {
+  using Base =
+      detail::stationary<radial<Sigma, Math>, Sigma>;
 
  public:
-  using number_t = Number;
+  using number_t = typename Base::number_t;
 
-  explicit radial(const Number& sigma)
-      : denominator_{two * sigma * sigma} {
-    assert(sigma > zero);
+  explicit radial(const Sigma& sigma) : Base{sigma} {
   }
 
-  template <class SampleX, class SampleY>
-  auto operator()(
-      const SampleX& x,  //
-      const SampleY& y) const {
-    constexpr auto nx = std::tuple_size_v<SampleX>;
-    constexpr auto ny = std::tuple_size_v<SampleY>;
-    static_assert(nx == ny);
-    return compute(x, y, std::make_index_sequence<nx>{});
+  template <class Distance>
+  auto evaluate(const Distance& r2) const {
+    return Math::exp(number_t{-0.5} * r2);
   }
 
- protected:
-  template <class SampleX, class SampleY, size_t... I>
-  auto compute(
-      const SampleX& x,  //
-      const SampleY& y,  //
-      std::index_sequence<I...>) const {
-    return std::exp(-(([&] {
-      const auto delta = std::get<I>(x) - std::get<I>(y);
-      return (delta * delta) / denominator_;
-    }() + ...)));
+  auto profile(
+      const number_t* r2, number_t* k, size_t n) const
+      -> void {
+    for (size_t i = 0; i < n; ++i) {
+      k[i] = number_t{-0.5} * r2[i];
+    }
+    Math::exp(k, k, n);
   }
 
- private:
-  const number_t denominator_{};
-};
-
-template <class Number, std::size_t N>
-class radial<std::array<Number, N> > {
-  static constexpr auto two = Number{2.0};
-  static constexpr auto zero = Number{0.0};
-  static constexpr auto init = [](auto... sigma) {
-    ((assert(sigma > zero)), ...);
-    return std::array{(two * sigma * sigma)...};
-  };
-
- public:
-  using number_t = Number;
-
-  explicit radial(const std::array<Number, N>& sigma)
-      : denominator_{std::apply(init, sigma)} {
+  template <class Rng>
+  auto gain(Rng&) const -> number_t {
+    return number_t{1};
   }
-
-  template <class SampleX, class SampleY>
-  auto operator()(
-      const SampleX& x,  //
-      const SampleY& y) const {
-    constexpr auto nx = std::tuple_size_v<SampleX>;
-    constexpr auto ny = std::tuple_size_v<SampleY>;
-    static_assert(nx == N, "dimension x mismatch");
-    static_assert(ny == N, "dimension y mismatch");
-    return compute(x, y, std::make_index_sequence<nx>{});
-  }
-
- protected:
-  template <class SampleX, class SampleY, size_t... I>
-  auto compute(
-      const SampleX& x,  //
-      const SampleY& y,  //
-      std::index_sequence<I...>) const {
-    return std::exp(-(([&] {
-      const auto delta = std::get<I>(x) - std::get<I>(y);
-      const auto denominator = std::get<I>(denominator_);
-      return (delta * delta) / denominator;
-    }() + ...)));
-  }
-
- private:
-  const std::array<number_t, N> denominator_{};
 };
 
 }  // namespace b2o::kernel
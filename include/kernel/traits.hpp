@@ -0,0 +1,31 @@
+#pragma once
+
+#include <type_traits>
+
+namespace b2o::kernel {
+
+// @brief Metric kernels
+//
+// A kernel is metric when it is a function of the scaled
+// squared distance only and exposes it:
+//
+//   scale(x)            x in units of the length scales ,
+//   profile(r2, k, n)   k[i] = f(r2[i]) for i < n ,
+//
+// with k(x, y) = f(|scale(x) - scale(y)|^2). The process
+// then builds kernel blocks from inner products (GEMM).
+//
+template <class Kernel, class = void>
+struct is_metric : std::false_type {};
+
+template <class Kernel>
+struct is_metric<
+    Kernel,
+    std::void_t<decltype(&Kernel::profile)>>
+    : std::true_type {};
+
+template <class Kernel>
+inline constexpr auto is_metric_v =
+    is_metric<Kernel>::value;
+
+}  // namespace b2o::kernel
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace b2o::math::approx {
+// @brief Branch-free approximations of the hot math
+//
+// Every function is a straight sequence of arithmetic,
+// min/max and bit operations, so loops over them (see the
+// pointer overloads) vectorize. Error bounds, measured
+// against libm (test_approx.cpp):
+//
+//   exp(x)    <= 2 ulp ,                 x in [-708, 709] ,
+//             gradual underflow below, inf above 709.78 .
+//   erfc(x)   relative error <= 1.2e-7 ,
+//   erf(x)    absolute error <= 1.2e-7 ,
+//   cdf(x)    absolute error <= 6.0e-8 , relative error
+//             <= 1.2e-7 in the lower tail (x < 0) .
+//
+// exp:  x = k ln2 + r, |r| <= ln2/2, e^r by a degree 13
+//       Taylor polynomial, 2^k assembled in the exponent.
+// erfc: Chebyshev fit t exp(-z^2 + P(t)), t = 1/(1 + z/2)
+//       (Numerical Recipes erfcc), using the fast exp.
+//
+// Arguments are first clamped to the range where the
+// kernels (detail::) are valid. The array forms do so in a
+// separate pass: fused in one loop, gcc jump-threads the
+// clamp into branches and gives up vectorizing.
+//
+namespace detail {
+// kernels: no range checks, |c| <= 1400, |x| <= 28
+inline auto exp(double c) -> double {
+  constexpr auto kLog2e = 1.44269504088896340736;
+  constexpr auto kLn2Hi = 6.93147180369123816490e-01;
+  constexpr auto kLn2Lo = 1.90821492927058770002e-10;
+  constexpr auto kShift = 6755399441055744.0;  // 1.5 * 2^52
+  constexpr auto kShiftBits =
+      std::uint64_t{0x4338000000000000};
+  // t holds k = round(c / ln2) in its low mantissa bits
+  const auto t = c * kLog2e + kShift;
+  const auto k = t - kShift;
+  const auto r = (c - k * kLn2Hi) - k * kLn2Lo;
+  // e^r = sum r^i / i!, i <= 13, Estrin's scheme
+  const auto r2 = r * r;
+  const auto r4 = r2 * r2;
+  const auto q0 = 1.0 + r;
+  const auto q1 = 1.0 / 2 + r * (1.0 / 6);
+  const auto q2 = 1.0 / 24 + r * (1.0 / 120);
+  const auto q3 = 1.0 / 720 + r * (1.0 / 5040);
+  const auto q4 = 1.0 / 40320 + r * (1.0 / 362880);
+  const auto q5 = 1.0 / 3628800 + r * (1.0 / 39916800);
+  const auto q6 = 1.0 / 479001600 + r * (1.0 / 6227020800);
+  const auto s0 = q0 + r2 * q1;
+  const auto s1 = q2 + r2 * q3;
+  const auto s2 = q4 + r2 * q5;
+  const auto p = s0 + r4 * (s1 + r4 * (s2 + r4 * q6));
+  // 2^k = 2^h * 2^(k-h), both halves assembled directly in
+  // the exponent field; the products underflow to zero and
+  // overflow to inf at the ends of the range on their own
+  auto bits = std::uint64_t{};
+  std::memcpy(&bits, &t, sizeof(bits));
+  const auto u = bits - kShiftBits + 2048;  // k + 2048
+  const auto h = u >> 1;
+  const auto lo = (h - 1) << 52;
+  const auto hi = (u - h - 1) << 52;
+  auto scale_lo = double{};
+  auto scale_hi = double{};
+  std::memcpy(&scale_lo, &lo, sizeof(scale_lo));
+  std::memcpy(&scale_hi, &hi, sizeof(scale_hi));
+  return (p * scale_lo) * scale_hi;
+}
+
+inline auto erfc(double x) -> double {
+  const auto z = std::abs(x);
+  const auto t = 1.0 / (1.0 + 0.5 * z);
+  auto p = 0.17087277;
+  p = p * t - 0.82215223;
+  p = p * t + 1.48851587;
+  p = p * t - 1.13520398;
+  p = p * t + 0.27886807;
+  p = p * t - 0.18628806;
+  p = p * t + 0.09678418;
+  p = p * t + 0.37409196;
+  p = p * t + 1.00002368;
+  p = p * t - 1.26551223;
+  const auto r = t * detail::exp(p - z * z);
+  // erfc(-z) = 2 - erfc(z), m = 1 for negative x
+  const auto m = 0.5 - std::copysign(0.5, x);
+  return r + m * (2.0 - 2.0 * r);
+}
+
+}  // namespace detail
+
+constexpr auto kExpMin = -746.0;  // e^x rounds to 0 below
+constexpr auto kExpMax = 710.0;   // e^x rounds to inf above
+constexpr auto kErfcMax = 28.0;  // erfc rounds to 0 above
+constexpr auto kInvSqrt2 = 0.707106781186547524400844362;
+
+inline auto exp(double x) -> double {
+  return detail::exp(
+      std::min(std::max(x, kExpMin), kExpMax));
+}
+
+inline auto erfc(double x) -> double {
+  return detail::erfc(
+      std::min(std::max(x, -kErfcMax), kErfcMax));
+}
+
+inline auto erf(double x) -> double {
+  return 1.0 - erfc(x);
+}
+
+// standard normal cumulative distribution
+inline auto cdf(double x) -> double {
+  return 0.5 * erfc(-x * kInvSqrt2);
+}
+
+// single precision evaluates in double, the error bounds
+// above hold after rounding
+template <
+    class Number,
+    std::enable_if_t<
+        std::is_same_v<Number, float>, int> = 0>
+inline auto exp(Number x) -> Number {
+  return static_cast<Number>(exp(double{x}));
+}
+
+template <
+    class Number,
+    std::enable_if_t<
+        std::is_same_v<Number, float>, int> = 0>
+inline auto erf(Number x) -> Number {
+  return static_cast<Number>(erf(double{x}));
+}
+
+template <
+    class Number,
+    std::enable_if_t<
+        std::is_same_v<Number, float>, int> = 0>
+inline auto cdf(Number x) -> Number {
+  return static_cast<Number>(cdf(double{x}));
+}
+
+// vectorizable array forms: y[i] = f(x[i]), y may alias x
+template <class Number>
+inline auto exp(const Number* x, Number* y, std::size_t n)
+    -> void {
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = std::min(
+        std::max(x[i], Number(kExpMin)), Number(kExpMax));
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = static_cast<Number>(detail::exp(y[i]));
+  }
+}
+
+template <class Number>
+inline auto erf(const Number* x, Number* y, std::size_t n)
+    -> void {
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = std::min(
+        std::max(x[i], Number(-kErfcMax)),
+        Number(kErfcMax));
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = static_cast<Number>(1.0 - detail::erfc(y[i]));
+  }
+}
+
+template <class Number>
+inline auto cdf(const Number* x, Number* y, std::size_t n)
+    -> void {
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto z = -x[i] * Number(kInvSqrt2);
+    y[i] = std::min(
+        std::max(z, Number(-kErfcMax)), Number(kErfcMax));
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = static_cast<Number>(0.5 * detail::erfc(y[i]));
+  }
+}
+
+}  // namespace b2o::math::approx
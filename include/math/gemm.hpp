@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace b2o::math {
+
+// @brief Cache-blocked matrix product C = A * B.T
+//
+// A (m x Depth) and B (n x Depth) are row major with
+// leading dimensions lda and ldb, C (m x n) is row major
+// with leading dimension ldc. Samples are stored as rows,
+// so A * B.T is the matrix of all their inner products.
+//
+// B is packed Tile rows at a time into a transposed
+// Depth x Tile panel P that stays in cache; rows of A then
+// update Tile wide segments of C with rank-1 steps,
+//
+//   C(i, j0 : j0 + Tile) += A(i, p) * P(p, :) ,
+//
+// kRows rows by kWidth columns at a time, accumulated in
+// registers, so the inner loop is a straight multiply-add
+// over the panel that compiles to FMA code. The depth (the
+// input dimension) is a compile time constant, the p loop
+// unrolls for the usual small dimensions.
+//
+template <
+    class Number,
+    std::size_t Depth,
+    std::size_t Tile = 64>
+class gemm {
+  static constexpr auto kRows = std::size_t{2};
+  static constexpr auto kWidth = std::size_t{8};
+  static_assert(Tile % kWidth == 0);
+
+ public:
+  auto operator()(
+      const Number* a, std::size_t lda,  //
+      const Number* b, std::size_t ldb,  //
+      Number* c, std::size_t ldc,        //
+      std::size_t m,                     //
+      std::size_t n) -> void {
+    panel_.resize(Depth * Tile);
+    for (std::size_t j0 = 0; j0 < n; j0 += Tile) {
+      const auto w = std::min(Tile, n - j0);
+      pack(b + j0 * ldb, ldb, w);
+      auto i = std::size_t{0};
+      for (; i + kRows <= m; i += kRows) {
+        rows<kRows>(
+            a + i * lda, lda, c + i * ldc + j0, ldc, w);
+      }
+      for (; i < m; ++i) {
+        rows<1>(
+            a + i * lda, lda, c + i * ldc + j0, ldc, w);
+      }
+    }
+  }
+
+ protected:
+  // P(p, j) = B(j, p), unused columns are zero
+  auto pack(const Number* b, std::size_t ldb, std::size_t w)
+      -> void {
+    std::fill(
+        std::begin(panel_), std::end(panel_), Number{0});
+    for (std::size_t j = 0; j < w; ++j) {
+      for (std::size_t p = 0; p < Depth; ++p) {
+        panel_[p * Tile + j] = b[j * ldb + p];
+      }
+    }
+  }
+
+  // the sweep covers the whole (zero padded) panel: a
+  // fixed trip count keeps gcc from vectorizing across
+  // the blocks instead of along them
+  template <std::size_t Rows>
+  auto rows(
+      const Number* a, std::size_t lda,  //
+      Number* c, std::size_t ldc,        //
+      std::size_t w) const -> void {
+    for (std::size_t j0 = 0; j0 < Tile; j0 += kWidth) {
+      Number acc[Rows][kWidth] = {};
+      for (std::size_t p = 0; p < Depth; ++p) {
+        const auto* panel = &panel_[p * Tile + j0];
+        for (std::size_t r = 0; r < Rows; ++r) {
+          const auto arp = a[r * lda + p];
+          for (std::size_t j = 0; j < kWidth; ++j) {
+            acc[r][j] += arp * panel[j];
+          }
+        }
+      }
+      if (j0 >= w) {
+        break;
+      }
+      const auto width = std::min(kWidth, w - j0);
+      for (std::size_t r = 0; r < Rows; ++r) {
+        std::copy_n(acc[r], width, c + r * ldc + j0);
+      }
+    }
+  }
+
+ private:
+  std::vector<Number> panel_;
+};
+
+}  // namespace b2o::math
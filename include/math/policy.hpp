@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+
+#include "dual/operations/erf.hpp"
+#include "dual/operations/exp.hpp"
+#include "dual/operations/multiplies.hpp"
+#include "dual/operations/plus.hpp"
+#include "math/approx.hpp"
+
+namespace b2o::dual {
+struct fast_exp : unary_operation<fast_exp> {
+  template <class T>
+  auto value(const T& v) const {
+    return math::approx::exp(v);
+  }
+  template <class T>
+  auto dvalue(const duo<T>& n) const {
+    return math::approx::exp(n.v) * n.d;
+  }
+};
+
+struct fast_erf : unary_operation<fast_erf> {
+  template <class T>
+  auto value(const T& v) const {
+    return math::approx::erf(v);
+  }
+  template <class T>
+  auto dvalue(const duo<T>& n) const {
+    return two_over_sqrt_pi<T> *
+           math::approx::exp(-n.v * n.v) * n.d;
+  }
+
+ private:
+  template <class T>
+  static constexpr T two_over_sqrt_pi =
+      T{1.12837916709551257389615890312154517L};
+};
+
+struct fast_cdf : unary_operation<fast_cdf> {
+  template <class T>
+  auto value(const T& v) const {
+    return math::approx::cdf(v);
+  }
+  template <class T>
+  auto dvalue(const duo<T>& n) const {
+    return inv_sqrt_2pi<T> *
+           math::approx::exp(T{-0.5} * n.v * n.v) * n.d;
+  }
+
+ private:
+  template <class T>
+  static constexpr T inv_sqrt_2pi =
+      T{0.39894228040143267793994605993438L};
+};
+}  // namespace b2o::dual
+
+namespace b2o::math {
+
+// @brief Math policies for kernels and distributions
+//
+// A policy provides exp, erf and the standard normal cdf
+// for plain and dual numbers, plus array forms
+// f(x, y, n): y[i] = f(x[i]) for the blocked code paths.
+//
+//   standard  libm (std::exp, std::erf)
+//   fast      branch-free approximations (math/approx.hpp),
+//             exp <= 2 ulp, erf/cdf absolute error ~1e-7
+//
+struct standard {
+  template <class T>
+  static auto exp(const T& x) {
+    return std::exp(x);
+  }
+
+  template <class T>
+  static auto erf(const T& x) {
+    return std::erf(x);
+  }
+
+  template <class T>
+  static auto cdf(const T& x) {
+    using scalar_t = decltype(value(x));
+    constexpr auto half = scalar_t{0.5L};
+    constexpr auto unit = scalar_t{1.0L};
+    constexpr auto inv_sqrt_2 =
+        scalar_t{0.707106781186547524400844362104849L};
+    return half * (unit + std::erf(x * inv_sqrt_2));
+  }
+
+  template <class Number>
+  static auto exp(const Number* x, Number* y, std::size_t n)
+      -> void {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] = std::exp(x[i]);
+    }
+  }
+
+ protected:
+  template <class T>
+  static auto value(const T& x) {
+    if constexpr (dual::is_number_v<T>) {
+      return x.value();
+    } else {
+      return x;
+    }
+  }
+};
+
+struct fast {
+  template <class T>
+  static auto exp(const T& x) {
+    if constexpr (dual::is_number_v<T>) {
+      return dual::fast_exp{}(x);
+    } else {
+      return approx::exp(x);
+    }
+  }
+
+  template <class T>
+  static auto erf(const T& x) {
+    if constexpr (dual::is_number_v<T>) {
+      return dual::fast_erf{}(x);
+    } else {
+      return approx::erf(x);
+    }
+  }
+
+  template <class T>
+  static auto cdf(const T& x) {
+    if constexpr (dual::is_number_v<T>) {
+      return dual::fast_cdf{}(x);
+    } else {
+      return approx::cdf(x);
+    }
+  }
+
+  template <class Number>
+  static auto exp(const Number* x, Number* y, std::size_t n)
+      -> void {
+    approx::exp(x, y, n);
+  }
+};
+
+}  // namespace b2o::math
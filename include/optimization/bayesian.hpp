@@ -1,83 +1,1277 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
-#include "helpers/debug.hpp"
-
-static auto debug = debug_3d{"./bayesian_debug.json"};
+#include "acquisition/traits.hpp"
+#include "gaussian/believer.hpp"
+#include "gaussian/classifier.hpp"
+#include "helpers/cache.hpp"
+#include "helpers/clock.hpp"
+#include "helpers/journal.hpp"
+#include "helpers/logging.hpp"
+#include "helpers/thread_pool.hpp"
+#include "optimization/stopping.hpp"
+#include "optimization/traits.hpp"
 
 namespace b2o::optimization {
 
 template <
-    template <class, class> class Acquisition,  //
-    template <class, class> class Optimizer,    //
-    class Model, class Domain, class Functor>
+    template <class...> class Acquisition,  //
+    template <class...> class Optimizer,    //
+    class Model,
+    class Domain,
+    class Functor,
+    class Observer = logging::none,
+    class OptimizerObserver = logging::none>
 class bayesian {
  public:
   using number_t = typename Model::number_t;
   using sample_t = typename Model::sample_t;
+  using input_t = typename sample_t::first_type;
 
   using acquisition_t = Acquisition<Model, number_t>;
-  using optimizer_t = Optimizer<acquisition_t, number_t>;
+  using optimizer_t = Optimizer<
+      acquisition_t,
+      number_t,
+      OptimizerObserver>;
   using config_t = typename optimizer_t::config_t;
 
-  bayesian(Model model, Domain domain, Functor functor)
+  using journal_t = b2o::journal<input_t, number_t>;
+  using cache_t = b2o::cache<input_t, number_t>;
+  using classifier_t =
+      gaussian::classifier<typename Model::process_t>;
+  using stopping_t = median_stopping<number_t>;
+  using trial_t = typename stopping_t::trial;
+  using believer_t = gaussian::believer<Model>;
+  using batch_acquisition_t =
+      Acquisition<believer_t, number_t>;
+  using batch_optimizer_t = Optimizer<
+      batch_acquisition_t,
+      number_t,
+      OptimizerObserver>;
+
+  // Fantasized observations of pending inputs: the
+  // posterior mean (Kriging believer, a copy of the model
+  // for independent acquisitions) or a constant liar, the
+  // best value so far, in a copy of the model
+  enum class fantasy { mean, liar };
+
+  // cost-aware acquisitions take the cost model as well
+  static constexpr auto kCostAware =
+      std::is_constructible_v<
+          acquisition_t,
+          const Model&,
+          number_t,
+          const Model&>;
+
+  // constrained acquisitions take the feasibility
+  // classifier as well
+  static constexpr auto kConstrained =
+      std::is_constructible_v<
+          acquisition_t,
+          const Model&,
+          number_t,
+          const classifier_t&>;
+
+  /// @param journal Evaluation journal
+  /// (helpers/journal.hpp), its recovered samples are
+  /// resumed instead of the first evaluation
+  bayesian(
+      Model model,
+      Domain domain,
+      Functor functor,
+      journal_t journal = {})
       : model_{std::move(model)},
+        cost_{model_.prior()},
+        feasible_{model_},
         domain_{std::move(domain)},
         functor_{std::move(functor)},
-        best_{domain_.start(), functor_(domain_.start())} {
-    model_.emplace(best_);
-    // debug entry
-    debug.print(std::pair{best_.first, best_.second}, model_);
+        journal_{std::move(journal)},
+        best_{domain_.start(), kUnlimited} {
+    if (resume(journal_.recovered())) {
+      return;
+    }
+    const auto [y, cost, stopped] = evaluate(best_.first);
+    offset_ = std::log(std::max(cost, kMinCost));
+    if (record({best_.first, y}, cost, stopped)) {
+      model_.emplace(
+          best_.first, y, noise(best_.first, stopped));
+      best_.second = stopped ? kUnlimited : y;
+    }
+    journal_.flush();
+    observer_.sample(best_, model_);
   }
 
   auto best() const -> const sample_t& {
     return best_;
   }
 
+  /// @brief Sample log (helpers/logging.hpp)
+  auto observer() const -> const Observer& {
+    return observer_;
+  }
+
+  /// @brief Wall clock seconds spent in the objective
+  auto spent() const -> number_t {
+    return spent_;
+  }
+
+  /// @brief Model of the objective
+  auto model() const -> const Model& {
+    return model_;
+  }
+
+  /// @brief Model of the log evaluation cost (relative to
+  /// the first evaluation), fitted by cost-aware
+  /// acquisitions only
+  auto cost() const -> const Model& {
+    return cost_;
+  }
+
+  /// @brief Classifier of feasible inputs (objectives
+  /// returning std::nullopt), fitted by constrained
+  /// acquisitions only
+  auto feasibility() const -> const classifier_t& {
+    return feasible_;
+  }
+
+  /// @brief Screening of gradient starts, off by default
+  /// @param candidates Quasi-random candidates per proposal
+  /// (0 turns screening off)
+  /// @param top Number of them refined by the optimizer
+  auto screening(size_t candidates, size_t top) -> void {
+    candidates_ = candidates;
+    top_ = top;
+  }
+
+  /// @brief Time budget of a proposal (acquisition
+  /// maximization), anytime optimizers
+  /// (optimization/traits.hpp) return their best so far
+  /// once it expires
+  /// @param seconds Budget per run step or propose call
+  auto deadline(number_t seconds) -> void {
+    budget_ = seconds;
+  }
+
+  /// @brief Whether every result reached the journal (a
+  /// failed write is retried by the next flush)
+  auto journaled() const -> bool {
+    return journal_.good();
+  }
+
+  /// @brief Proposal latencies (the last 1024), e.g.
+  /// latency().p99()
+  auto latency() const -> const b2o::latency& {
+    return latency_;
+  }
+
+  /// @brief Evaluation cache tolerance (max norm, input
+  /// units): proposals this close to an evaluated input are
+  /// re-proposed, such samples stay out of the model
+  auto tolerance(number_t tolerance) -> void {
+    cache_.reset(tolerance);
+  }
+
+  /// @brief Early stopping of objectives with
+  /// intermediate reports, f(x, trial) (see
+  /// optimization/stopping.hpp). A stopped evaluation
+  /// enters the model as a low-fidelity sample: its last
+  /// value with an extra noise variance of the prior one
+  /// k(x, x), and it never becomes the best (nor a trust
+  /// region success). The journal does not keep the flag,
+  /// resumed ones are exact samples.
+  /// @param grace Steps never stopped
+  /// @param trials Completed trials before stopping any
+  auto early_stopping(size_t grace, size_t trials) -> void {
+    stopping_.configure(grace, trials);
+  }
+
+  /// @brief Number of evaluations stopped early
+  auto stopped() const -> size_t {
+    return stopping_.stopped();
+  }
+
+  /// @brief Starts around the best input per proposal, run
+  /// in parallel with the screened ones (one by default,
+  /// e.g. restarts(thread_pool::instance().size()))
+  /// @param restarts Number of starts, each with its own
+  /// random stream of the domain
+  auto restarts(size_t restarts) -> void {
+    restarts_ = std::max(restarts, size_t{1});
+  }
+
   auto warmup(size_t steps) -> void {
     auto& [x_best, y_best] = best_;
 
     for (std::size_t s = 0; s < steps; ++s) {
-      const auto x_next = domain_.random();
-      const auto y_next = functor_(x_next);
-      model_.emplace(x_next, y_next);
-      if (y_next < y_best) {
+      const auto x_next = initial();
+      const auto [y_next, cost, stopped] = evaluate(x_next);
+      if (record({x_next, y_next}, cost, stopped)) {
+        model_.emplace(
+            x_next, y_next, noise(x_next, stopped));
+      }
+      if (!stopped && improves(x_next, y_next)) {
         x_best = x_next;
         y_best = y_next;
       }
-      // debug entry
-      debug.print(std::pair{x_next, y_next}, model_);
+      observer_.sample(std::pair{x_next, y_next}, model_);
     }
+    journal_.flush();
   }
 
-  auto run(size_t steps, config_t config) -> void {
+  /// @brief Optimization steps
+  /// @param budget Stop once the objective has taken this
+  /// many seconds in total (see spent())
+  auto run(
+      size_t steps,
+      config_t config,
+      number_t budget = kUnlimited) -> void {
     auto& [x_best, y_best] = best_;
 
+    sync();
     for (std::size_t s = 0; s < steps; ++s) {
-      const auto acq = acquisition_t{model_, y_best};
-      const auto opt = optimizer_t{acq, config};
-
-      const auto x_gen = domain_.generate(x_best);
-      const auto x_max = opt.maximize(x_gen);
-      const auto x_next = domain_.project(x_max);
-      const auto y_next = functor_(x_next);
-      model_.emplace(x_next, y_next);
-      if (y_next < y_best) {
+      if (spent_ >= budget) {
+        break;
+      }
+      const auto watch = stopwatch{};
+      const auto acq = acquire<acquisition_t>(model_);
+      const auto opt =
+          optimize<optimizer_t>(acq, timed(config));
+
+      const auto x_next = distinct(acq, opt);
+      latency_.record(watch.elapsed());
+      const auto [y_next, cost, stopped] = evaluate(x_next);
+      if (record({x_next, y_next}, cost, stopped)) {
+        model_.emplace(
+            x_next, y_next, noise(x_next, stopped));
+      }
+      if (!stopped && y_next < y_best) {
+        x_best = x_next;
+        y_best = y_next;
+      }
+      observer_.sample(
+          std::pair{x_next, y_next}, model_, acq);
+    }
+    journal_.flush();
+  }
+
+  /// @brief Propose q inputs from the current model
+  ///
+  /// Independent acquisitions (acquisition/traits.hpp) are
+  /// maximized concurrently on the thread pool. Otherwise
+  /// Kriging believer: every proposal maximizes the
+  /// acquisition with the previous ones pending, their
+  /// variance conditioned away through the joint posterior
+  /// (gaussian/believer.hpp), so the batch spreads out.
+  auto propose(size_t q, config_t config)
+      -> std::vector<input_t> {
+    const auto watch = stopwatch{};
+    sync();
+    config = timed(config);
+    auto batch = std::vector<input_t>{};
+    batch.reserve(q);
+    if constexpr (acquisition::is_independent_v<
+                      acquisition_t>) {
+      auto x = std::vector<starts_t>{};
+      auto seeds = std::vector<std::uint64_t>{};
+      for (std::size_t i = 0; i < q; ++i) {
+        x.emplace_back(starts());
+        seeds.emplace_back(seed<acquisition_t, Model>());
+      }
+      batch.resize(q);
+      thread_pool::instance().parallel_for(
+          q, [&](std::size_t i) {
+            const auto acq = acquire<acquisition_t>(
+                model_, best_.second, seeds[i]);
+            const auto opt =
+                optimize<optimizer_t>(acq, config);
+            batch[i] = maximize(acq, opt, std::move(x[i]));
+          });
+      for (auto& x_next : batch) {
+        if (cache_.find(x_next)) {
+          const auto acq = acquire<acquisition_t>(model_);
+          const auto opt =
+              optimize<optimizer_t>(acq, config);
+          x_next = distinct(acq, opt);
+        }
+      }
+    } else {
+      auto model = believer_t{model_};
+      auto believed = best_.second;
+      for (std::size_t i = 0; i < q; ++i) {
+        const auto acq =
+            acquire<batch_acquisition_t>(model, believed);
+        const auto opt =
+            optimize<batch_optimizer_t>(acq, config);
+
+        const auto x_next = distinct(acq, opt);
+        model.condition(x_next);
+        believed = believe(x_next, believed);
+        batch.emplace_back(x_next);
+      }
+    }
+    latency_.record(watch.elapsed());
+    return batch;
+  }
+
+  /// @brief Add evaluated samples with a single solve
+  /// @param costs Their evaluation seconds, if known
+  /// @param stopped Whether each one was stopped early (a
+  /// partial value, see early_stopping), none if empty
+  /// @return false if they could not be journaled
+  auto ingest(
+      const std::vector<sample_t>& samples,
+      const std::vector<number_t>& costs = {},
+      const std::vector<bool>& stopped = {}) -> bool {
+    auto& [x_best, y_best] = best_;
+
+    auto fresh = std::vector<sample_t>{};
+    auto noises = std::vector<number_t>{};
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+      const auto cost =
+          (i < costs.size()) ? costs[i] : kUnknown;
+      const auto partial =
+          (i < stopped.size()) && stopped[i];
+      if (record(samples[i], cost, partial)) {
+        fresh.emplace_back(samples[i]);
+        noises.emplace_back(
+            noise(samples[i].first, partial));
+      }
+    }
+    if (!fresh.empty()) {
+      model_.emplace(fresh, noises);
+    }
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+      const auto& [x_next, y_next] = samples[i];
+      const auto partial =
+          (i < stopped.size()) && stopped[i];
+      if (!partial && improves(x_next, y_next)) {
         x_best = x_next;
         y_best = y_next;
       }
-      // debug entry
-      debug.print(std::pair{x_next, y_next}, model_, acq);
+      observer_.sample(std::pair{x_next, y_next}, model_);
     }
+    return journal_.flush();
+  }
+
+  /// @brief One batch step: propose q inputs, evaluate
+  /// them concurrently, each on its own thread (the
+  /// objective must be thread safe, the thread pool is left
+  /// to the solvers), and ingest the results. An exception
+  /// of the objective is rethrown once the other results
+  /// are ingested.
+  /// @return The evaluated samples
+  auto run_batch(size_t q, config_t config)
+      -> std::vector<sample_t> {
+    const auto batch = propose(q, config);
+    auto results = std::vector<evaluation_t>(batch.size());
+    auto errors =
+        std::vector<std::exception_ptr>(batch.size());
+    {
+      auto slots = slots_t{};
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        slots.threads.emplace_back([&, i] {
+          try {
+            results[i] = evaluate(batch[i]);
+          } catch (...) {
+            errors[i] = std::current_exception();
+          }
+        });
+      }
+    }
+    auto evaluated = std::vector<sample_t>{};
+    auto costs = std::vector<number_t>{};
+    auto stopped = std::vector<bool>{};
+    auto error = std::exception_ptr{};
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      if (errors[i]) {
+        error = error ? error : errors[i];
+        continue;
+      }
+      evaluated.emplace_back(batch[i], results[i].y);
+      costs.emplace_back(results[i].cost);
+      stopped.emplace_back(results[i].stopped);
+    }
+    ingest(evaluated, costs, stopped);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return evaluated;
+  }
+
+  /// @brief Warmup with up to P evaluations in flight
+  auto warmup(size_t steps, size_t parallel) -> void {
+    dispatch(steps, parallel, [this](const auto&) {
+      return initial();
+    });
+  }
+
+  /// @brief Asynchronous optimization steps
+  ///
+  /// Up to P evaluations run at once, each on its own
+  /// thread (the objective must be thread safe). Every
+  /// completed one is ingested as it arrives and its slot
+  /// refilled with a proposal conditioned on the inputs
+  /// still pending (see fantasy), so the throughput scales
+  /// with P instead of being serial.
+  /// @param parallel Evaluations in flight (P)
+  /// @param lie Fantasized observations of pending inputs
+  auto run_async(
+      size_t steps,
+      size_t parallel,
+      config_t config,
+      fantasy lie = fantasy::mean) -> void {
+    dispatch(steps, parallel, [&](const auto& pending) {
+      const auto watch = stopwatch{};
+      const auto x_next = fantasize(pending, config, lie);
+      latency_.record(watch.elapsed());
+      return x_next;
+    });
+  }
+
+  /// @brief Trust region steps (TuRBO)
+  ///
+  /// Instead of the global model, every step refines one
+  /// of m local boxes (round robin), each around its own
+  /// incumbent with a side of L times the domain:
+  ///
+  ///   - a local model is fitted on the samples inside the
+  ///     box only (one solve, n_local << n) ,
+  ///   - the acquisition is maximized inside the box (a
+  ///     domain of its own) ,
+  ///   - tau_s successes in a row double L, tau_f = max(4,
+  ///     D) failures in a row halve it, below L_min the box
+  ///     restarts around a random input .
+  ///
+  /// The global model is brought up to date lazily, by the
+  /// next global step. The domain must be a box
+  /// (domain::bounds).
+  /// @param regions Number of boxes (m, at least one)
+  auto run_trust(
+      size_t steps,
+      config_t config,
+      size_t regions = 1) -> void {
+    auto& [x_best, y_best] = best_;
+
+    regions = std::max(regions, size_t{1});
+    while (regions_.size() < regions) {
+      regions_.emplace_back(
+          regions_.empty()
+              ? region_t{best_.first, best_.second}
+              : region_t{domain_.random(), kUnlimited});
+    }
+    for (std::size_t s = 0; s < steps; ++s) {
+      auto& r = regions_[s % regions];
+      const auto watch = stopwatch{};
+      auto box = trust_box(r);
+      auto local = model_.prior();
+      auto samples = std::vector<sample_t>{};
+      auto noises = std::vector<number_t>{};
+      auto y_local = kUnlimited;
+      const auto& cached = cache_.samples();
+      for (std::size_t i = 0; i < cached.size(); ++i) {
+        const auto& [x, y] = cached[i];
+        if (inside(box, x) && !std::isnan(y)) {
+          samples.emplace_back(cached[i]);
+          noises.emplace_back(noise(x, partial_[i]));
+          y_local = partial_[i] ? y_local
+                                : std::min(y_local, y);
+        }
+      }
+      local.emplace(samples, noises);
+      auto x_next = input_t{};
+      if (samples.empty()) {
+        x_next = box.random();
+      } else {
+        const auto acq =
+            acquire<acquisition_t>(local, y_local);
+        const auto opt = optimize<optimizer_t>(
+            acq, timed(config), box);
+        x_next = distinct(acq, opt, box, r.center);
+      }
+      latency_.record(watch.elapsed());
+
+      const auto [y_next, cost, stopped] = evaluate(x_next);
+      if (record({x_next, y_next}, cost, stopped)) {
+        stale_.emplace_back(x_next, y_next);
+        stale_noise_.emplace_back(noise(x_next, stopped));
+      }
+      if (!stopped && y_next < y_best) {
+        x_best = x_next;
+        y_best = y_next;
+      }
+      observer_.sample(std::pair{x_next, y_next}, local);
+      // a partial value counts as a failure
+      trust_update(
+          r, x_next, stopped ? kUnknown : y_next);
+    }
+    journal_.flush();
+  }
+
+  /// @brief Multi-fidelity steps
+  ///
+  /// For multi-fidelity objectives (optimization/
+  /// fidelity.hpp, the last input coordinate is the
+  /// fidelity s, fixed at the target by the domain): the
+  /// acquisition picks x at the target, then the level
+  /// that most reduces the target variance per unit cost,
+  ///
+  ///   cov(x_t, x_m)^2 / (var(x_m) + noise) / cost_m ,
+  ///
+  /// from the joint posterior, so cheap levels are
+  /// evaluated while they still inform the target. Only
+  /// target samples become the best.
+  /// @param budget Stop once the objective has taken this
+  /// many seconds in total (see spent())
+  auto run_fidelity(
+      size_t steps,
+      config_t config,
+      number_t budget = kUnlimited) -> void {
+    static_assert(
+        is_multi_fidelity_v<Functor>,
+        "run_fidelity needs a multi-fidelity objective");
+    auto& [x_best, y_best] = best_;
+    const auto& levels = functor_.levels();
+    const auto& costs = functor_.costs();
+    const auto target = functor_.target();
+
+    sync();
+    for (std::size_t s = 0; s < steps; ++s) {
+      if (spent_ >= budget) {
+        break;
+      }
+      const auto watch = stopwatch{};
+      const auto acq = acquire<acquisition_t>(model_);
+      const auto opt =
+          optimize<optimizer_t>(acq, timed(config));
+
+      auto x_next = distinct(acq, opt);
+      x_next.back() = target;
+      auto xs = std::vector<input_t>{x_next};
+      for (const auto level : levels) {
+        xs.emplace_back(x_next);
+        xs.back().back() = level;
+      }
+      const auto cov = model_.predict_joint(xs).second;
+      auto score = number_t{0};
+      for (std::size_t m = 0; m < levels.size(); ++m) {
+        const auto c = cov[0][m + 1];
+        const auto var = cov[m + 1][m + 1] + model_.noise();
+        const auto gain =
+            c * c / var / std::max(costs[m], kMinCost);
+        if (gain > score && !cache_.find(xs[m + 1])) {
+          score = gain;
+          x_next = xs[m + 1];
+        }
+      }
+      latency_.record(watch.elapsed());
+      const auto [y_next, cost, stopped] = evaluate(x_next);
+      if (record({x_next, y_next}, cost, stopped)) {
+        model_.emplace(
+            x_next, y_next, noise(x_next, stopped));
+      }
+      if (!stopped && improves(x_next, y_next)) {
+        x_best = x_next;
+        y_best = y_next;
+      }
+      observer_.sample(
+          std::pair{x_next, y_next}, model_, acq);
+    }
+    journal_.flush();
+  }
+
+ protected:
+  // Trust region: incumbent, side (fraction of the domain)
+  // and the successes / failures in a row
+  struct region_t {
+    input_t center;
+    number_t best;
+    number_t length{kLengthInit};
+    size_t success{0};
+    size_t failure{0};
+  };
+
+  // Box of a region, drawing from a stream seeded from the
+  // domain (reproducible with it)
+  auto trust_box(const region_t& r) -> Domain {
+    auto config = domain_.config();
+    for (std::size_t d = 0; d < config.size(); ++d) {
+      auto& [lo, hi] = config[d];
+      const auto half = r.length * (hi - lo) / 2;
+      const auto c = std::clamp(r.center[d], lo, hi);
+      lo = std::max(lo, c - half);
+      hi = std::min(hi, c + half);
+    }
+    auto box = Domain{config, r.center};
+    box.seed(domain_.next_seed());
+    return box;
+  }
+
+  static auto inside(const Domain& box, const input_t& x)
+      -> bool {
+    const auto& config = box.config();
+    for (std::size_t d = 0; d < config.size(); ++d) {
+      const auto& [lo, hi] = config[d];
+      if (x[d] < lo || x[d] > hi) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto trust_update(
+      region_t& r, const input_t& x, number_t y) -> void {
+    // a new (or restarted) region centers on its first
+    // feasible evaluation
+    if (!std::isfinite(r.best)) {
+      if (!std::isnan(y)) {
+        r.center = x;
+        r.best = y;
+      }
+      return;
+    }
+    const auto dimension = std::tuple_size_v<input_t>;
+    const auto failures = std::max(kFailures, dimension);
+    if (y < r.best - kImprovement * std::abs(r.best)) {
+      r.center = x;
+      r.best = y;
+      r.failure = 0;
+      if (++r.success >= kSuccesses) {
+        r.length = std::min(2 * r.length, kLengthMax);
+        r.success = 0;
+      }
+    } else {
+      r.success = 0;
+      if (++r.failure >= failures) {
+        r.length /= 2;
+        r.failure = 0;
+      }
+    }
+    if (r.length < kLengthMin) {
+      r = region_t{domain_.random(), kUnlimited};
+    }
+  }
+
+  // Random warmup input. Multi-fidelity objectives draw
+  // its level with a probability proportional to 1 / cost,
+  // so the first samples are mostly cheap ones (the start
+  // and a share of them stay at the target).
+  auto initial() -> input_t {
+    auto x = domain_.random();
+    if constexpr (is_multi_fidelity_v<Functor>) {
+      const auto& levels = functor_.levels();
+      auto weights = std::vector<number_t>{};
+      for (const auto cost : functor_.costs()) {
+        weights.emplace_back(1 / std::max(cost, kMinCost));
+      }
+      auto rng = std::mt19937_64{domain_.next_seed()};
+      auto level = std::discrete_distribution<size_t>{
+          std::cbegin(weights), std::cend(weights)};
+      x.back() = levels[level(rng)];
+    }
+    return x;
+  }
+
+  // Whether a sample improves on the best, only target
+  // samples do for multi-fidelity objectives
+  auto improves(const input_t& x, number_t y) const
+      -> bool {
+    if constexpr (is_multi_fidelity_v<Functor>) {
+      if (x.back() != functor_.target()) {
+        return false;
+      }
+    }
+    return y < best_.second;
+  }
+
+  // Bring the model up to date with the samples of the
+  // trust region steps (one solve)
+  auto sync() -> void {
+    if (!stale_.empty()) {
+      model_.emplace(stale_, stale_noise_);
+      stale_.clear();
+      stale_noise_.clear();
+    }
+  }
+
+  // Without a first evaluation, nothing observed until the
+  // first ingest or the samples of the journal (ask/tell,
+  // see optimization/study.hpp)
+  struct deferred_t {};
+
+  bayesian(
+      Model model,
+      Domain domain,
+      Functor functor,
+      deferred_t,
+      journal_t journal = {})
+      : model_{std::move(model)},
+        cost_{model_.prior()},
+        feasible_{model_},
+        domain_{std::move(domain)},
+        functor_{std::move(functor)},
+        journal_{std::move(journal)},
+        best_{domain_.start(), kUnlimited} {
+    resume(journal_.recovered());
+  }
+
+  // Objective value, its wall clock seconds and whether
+  // the stopping rule cut it short (a partial value)
+  struct evaluation_t {
+    number_t y;
+    number_t cost;
+    bool stopped;
+  };
+
+  // Reporting objectives run as a trial of the stopping
+  // rule, infeasible ones (see record) give NaN
+  auto evaluate(const input_t& x) -> evaluation_t {
+    constexpr auto reporting =
+        is_reporting_v<Functor, input_t, trial_t>;
+    const auto watch = stopwatch{};
+    auto stopped = false;
+    const auto y = [&] {
+      if constexpr (reporting) {
+        auto trial = trial_t{stopping_};
+        const auto result = functor_(x, trial);
+        stopped = trial.stopped();
+        return result;
+      } else {
+        return functor_(x);
+      }
+    }();
+    const auto seconds = watch.elapsed();
+    return {
+        value(y), static_cast<number_t>(seconds), stopped};
+  }
+
+  // Extra noise variance of a sample in the model: stopped
+  // evaluations are low-fidelity samples, their partial
+  // value as uncertain as the prior at x
+  auto noise(const input_t& x, bool stopped) const
+      -> number_t {
+    return stopped ? model_.variance(x) : number_t{0};
+  }
+
+  // Objective values, std::nullopt (infeasible) as NaN
+  template <class T>
+  static auto value(const T& y) -> number_t {
+    return static_cast<number_t>(y);
+  }
+
+  template <class T>
+  static auto value(const std::optional<T>& y) -> number_t {
+    return y ? static_cast<number_t>(*y) : kUnknown;
+  }
+
+  // Account a sample: journal, evaluation cache, spent
+  // time, cost model and feasibility classifier, NaN cost
+  // if unknown, NaN value if infeasible (model updates are
+  // left to the caller)
+  // @return false for duplicates of cached samples and
+  // infeasible ones, to be kept out of the model
+  auto record(
+      const sample_t& s,
+      const number_t& cost,
+      bool stopped = false) -> bool {
+    journal_.append(s.first, s.second, cost);
+    const auto fresh = (cache_.find(s.first) == nullptr);
+    const auto feasible = !std::isnan(s.second);
+    if (fresh) {
+      cache_.insert(s.first, s.second);
+      partial_.emplace_back(stopped);
+      if constexpr (kConstrained) {
+        feasible_.emplace(s.first, feasible);
+      }
+    }
+    if (std::isnan(cost)) {
+      return fresh && feasible;
+    }
+    spent_ += cost;
+    if constexpr (kCostAware) {
+      if (fresh) {
+        const auto c = std::max(cost, kMinCost);
+        cost_.emplace(s.first, std::log(c) - offset_);
+      }
+    }
+    return fresh && feasible;
+  }
+
+  // Bulk load of journal records with one full solve per
+  // model, false when there are none
+  auto resume(
+      const std::vector<typename journal_t::record_t>&
+          records) -> bool {
+    if (records.empty()) {
+      return false;
+    }
+    const auto& first = records.front();
+    best_ = {first.x, kUnlimited};
+    const auto c0 = std::max(first.cost, kMinCost);
+    offset_ = std::isfinite(first.cost) ? std::log(c0)
+                                        : number_t{0};
+    auto samples = std::vector<sample_t>{};
+    auto costs = std::vector<sample_t>{};
+    using label_t = typename classifier_t::label_t;
+    auto labels = std::vector<label_t>{};
+    samples.reserve(records.size());
+    const auto finite = [](number_t v) {
+      return std::isfinite(v);
+    };
+    for (const auto& [x, y, cost] : records) {
+      // corrupt records (infinite values) are skipped
+      if (std::isinf(y) ||
+          !std::all_of(
+              std::cbegin(x), std::cend(x), finite)) {
+        continue;
+      }
+      if (improves(x, y)) {
+        best_ = {x, y};
+      }
+      if (cache_.find(x)) {
+        spent_ += finite(cost) ? cost : number_t{0};
+        continue;
+      }
+      cache_.insert(x, y);
+      partial_.emplace_back(false);
+      labels.emplace_back(x, !std::isnan(y));
+      if (!std::isnan(y)) {
+        samples.emplace_back(x, y);
+      }
+      if (finite(cost)) {
+        spent_ += cost;
+        const auto c = std::max(cost, kMinCost);
+        costs.emplace_back(x, std::log(c) - offset_);
+      }
+    }
+    model_.load(samples);
+    if constexpr (kCostAware) {
+      cost_.load(costs);
+    }
+    if constexpr (kConstrained) {
+      feasible_.load(labels);
+    }
+    return true;
+  }
+
+  template <class Acq, class M>
+  auto acquire(const M& model) -> Acq {
+    return acquire<Acq>(model, best_.second);
+  }
+
+  template <class Acq, class M>
+  auto acquire(const M& model, number_t best) -> Acq {
+    return acquire<Acq>(model, best, seed<Acq, M>());
+  }
+
+  // Before the first feasible sample (best = inf) the
+  // improvement is over the prior mean, zero. Seeded
+  // acquisitions (acquisition/traits.hpp) get the seed.
+  template <class Acq, class M>
+  auto acquire(
+      const M& model,
+      number_t best,
+      std::uint64_t seed) const -> Acq {
+    constexpr auto seeded =
+        acquisition::is_seeded_v<Acq, M, number_t>;
+    if (!(best < kUnlimited)) {
+      best = number_t{0};
+    }
+    if constexpr (kCostAware) {
+      return Acq{model, best, cost_};
+    } else if constexpr (kConstrained) {
+      return Acq{model, best, feasible_};
+    } else if constexpr (seeded) {
+      return Acq{model, best, seed};
+    } else {
+      return Acq{model, best};
+    }
+  }
+
+  // Seed of a seeded acquisition, from the domain stream
+  template <class Acq, class M>
+  auto seed() -> std::uint64_t {
+    constexpr auto seeded =
+        acquisition::is_seeded_v<Acq, M, number_t>;
+    if constexpr (seeded) {
+      return domain_.next_seed();
+    } else {
+      return 0;
+    }
+  }
+
+  // Evaluation threads, joined on every exit
+  struct slots_t {
+    std::vector<std::thread> threads;
+    ~slots_t() {
+      for (auto& thread : threads) {
+        if (thread.joinable()) {
+          thread.join();
+        }
+      }
+    }
+  };
+
+  // Evaluation slots: next(pending) proposes the input of
+  // every free slot, results are ingested in completion
+  // order. An exception of the objective stops launching,
+  // the evaluations in flight are still ingested, then it
+  // is rethrown; threads are joined on every exit.
+  template <class Next>
+  auto dispatch(size_t steps, size_t parallel, Next next)
+      -> void {
+    struct result_t {
+      size_t slot;
+      sample_t sample;
+      number_t cost;
+      bool stopped;
+      std::exception_ptr error;
+    };
+    auto mutex = std::mutex{};
+    auto ready = std::condition_variable{};
+    auto done = std::deque<result_t>{};
+    auto slots = slots_t{std::vector<std::thread>(
+        std::max(parallel, size_t{1}))};
+    const auto size = slots.threads.size();
+    auto busy = std::vector<bool>(size);
+    auto inputs = std::vector<input_t>(size);
+    const auto launch = [&](size_t k) {
+      auto pending = std::vector<input_t>{};
+      for (std::size_t i = 0; i < size; ++i) {
+        if (busy[i]) {
+          pending.emplace_back(inputs[i]);
+        }
+      }
+      inputs[k] = next(pending);
+      busy[k] = true;
+      slots.threads[k] = std::thread{[&, k, x = inputs[k]] {
+        auto result =
+            result_t{k, {x, kUnknown}, kUnknown, false};
+        try {
+          const auto [y, cost, stopped] = evaluate(x);
+          result.sample.second = y;
+          result.cost = cost;
+          result.stopped = stopped;
+        } catch (...) {
+          result.error = std::current_exception();
+        }
+        const auto lock = std::lock_guard{mutex};
+        done.push_back(std::move(result));
+        ready.notify_one();
+      }};
+    };
+    auto launched = size_t{0};
+    for (; launched < std::min(steps, size); ++launched) {
+      launch(launched);
+    }
+    auto error = std::exception_ptr{};
+    for (std::size_t s = 0; s < launched; ++s) {
+      auto lock = std::unique_lock{mutex};
+      ready.wait(lock, [&done] { return !done.empty(); });
+      const auto result = std::move(done.front());
+      done.pop_front();
+      lock.unlock();
+
+      slots.threads[result.slot].join();
+      busy[result.slot] = false;
+      if (result.error) {
+        error = error ? error : result.error;
+        continue;
+      }
+      ingest(
+          {result.sample}, {result.cost}, {result.stopped});
+      if (!error && launched < steps) {
+        launch(result.slot);
+        ++launched;
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Proposal conditioned on the pending inputs
+  auto fantasize(
+      const std::vector<input_t>& pending,
+      const config_t& config,
+      fantasy lie) -> input_t {
+    // nothing observed yet (deferred): the start, then
+    // random inputs
+    if (!(best_.second < kUnlimited)) {
+      return pending.empty() ? best_.first
+                             : domain_.random();
+    }
+    sync();
+    const auto timed_config = timed(config);
+    if (pending.empty()) {
+      const auto acq = acquire<acquisition_t>(model_);
+      const auto opt =
+          optimize<optimizer_t>(acq, timed_config);
+      return distinct(acq, opt);
+    }
+    // believers need a conditioned acquisition
+    constexpr auto independent =
+        acquisition::is_independent_v<acquisition_t>;
+    if constexpr (!independent) {
+      if (lie == fantasy::mean) {
+        auto model = believer_t{model_};
+        auto believed = best_.second;
+        for (const auto& x : pending) {
+          model.condition(x);
+          believed = believe(x, believed);
+        }
+        const auto acq =
+            acquire<batch_acquisition_t>(model, believed);
+        const auto opt = optimize<batch_optimizer_t>(
+            acq, timed_config);
+        return distinct(acq, opt);
+      }
+    }
+    auto model = model_;
+    auto lies = std::vector<sample_t>{};
+    for (const auto& x : pending) {
+      const auto y = (lie == fantasy::liar)
+                         ? best_.second
+                         : std::get<0>(model_.predict(x));
+      lies.emplace_back(x, y);
+    }
+    model.emplace(lies);
+    const auto acq = acquire<acquisition_t>(model);
+    const auto opt =
+        optimize<optimizer_t>(acq, timed_config);
+    return distinct(acq, opt);
+  }
+
+  // Best value once a pending input returns its posterior
+  // mean (Kriging believer), so that no improvement is
+  // left at the pending inputs themselves
+  auto believe(const input_t& x, number_t best) const
+      -> number_t {
+    return std::min(best, std::get<0>(model_.predict(x)));
+  }
+
+  // Maximum of the acquisition away from the evaluated
+  // inputs (evaluation cache): re-proposed from new starts,
+  // a random input as a last resort
+  template <class Acq, class Opt>
+  auto distinct(const Acq& acq, const Opt& opt) -> input_t {
+    return distinct(acq, opt, domain_, best_.first);
+  }
+
+  template <class Acq, class Opt>
+  auto distinct(
+      const Acq& acq,
+      const Opt& opt,
+      Domain& domain,
+      const input_t& center) -> input_t {
+    for (std::size_t r = 0; r < kRetries; ++r) {
+      auto x = maximize(acq, opt, starts(domain, center));
+      if (!cache_.find(x)) {
+        return x;
+      }
+    }
+    return domain.random();
+  }
+
+  // Config with the proposal deadline from now, for
+  // anytime optimizers (optimization/traits.hpp)
+  auto timed(config_t config) const -> config_t {
+    if constexpr (is_anytime_v<config_t>) {
+      config.deadline = b2o::deadline::min(
+          config.deadline, b2o::deadline{budget_});
+    }
+    return config;
+  }
+
+  // Bounded optimizers (optimization/traits.hpp) get the
+  // limits of the domain
+  template <class Opt, class Acq>
+  auto optimize(const Acq& acq, const config_t& config)
+      const -> Opt {
+    return optimize<Opt>(acq, config, domain_);
+  }
+
+  template <class Opt, class Acq>
+  static auto optimize(
+      const Acq& acq,
+      const config_t& config,
+      const Domain& domain) -> Opt {
+    constexpr auto bounded =
+        is_bounded_v<Opt, Acq, config_t, Domain>;
+    if constexpr (bounded) {
+      return Opt{acq, config, domain.config()};
+    } else {
+      return Opt{acq, config};
+    }
+  }
+
+  // Starts of one proposal: quasi-random candidates of the
+  // domain to be screened (until the proposal deadline),
+  // and one stream of the domain per restart around the
+  // center (forked here, drawn from by the concurrent
+  // tasks)
+  struct starts_t {
+    std::vector<input_t> candidates;
+    std::vector<Domain> streams;
+    input_t center;
+    const Domain* domain;
+    b2o::deadline deadline;
+  };
+
+  auto starts() -> starts_t {
+    return starts(domain_, best_.first);
+  }
+
+  auto starts(Domain& domain, const input_t& center)
+      -> starts_t {
+    auto result = starts_t{};
+    result.candidates = domain.candidates(candidates_);
+    for (std::size_t r = 0; r < restarts_; ++r) {
+      result.streams.emplace_back(domain.fork());
+    }
+    result.center = center;
+    result.domain = &domain;
+    result.deadline = b2o::deadline{budget_};
+    return result;
+  }
+
+  // Batched scores of the candidates, chunk by chunk until
+  // the deadline (a prefix of them once it expires)
+  template <class Acq>
+  static auto screen(
+      const Acq& acq,
+      const std::vector<input_t>& x,
+      const b2o::deadline& deadline)
+      -> std::vector<number_t> {
+    auto score = std::vector<number_t>{};
+    score.reserve(x.size());
+    for (std::size_t beg = 0;
+         beg < x.size() && !deadline.expired();
+         beg += kChunk) {
+      const auto end = std::min(beg + kChunk, x.size());
+      const auto chunk = acq.score(std::vector<input_t>(
+          std::cbegin(x) + beg, std::cbegin(x) + end));
+      score.insert(
+          std::end(score),
+          std::cbegin(chunk),
+          std::cend(chunk));
+    }
+    return score;
+  }
+
+  // Multistart: the top screened candidates (batched
+  // acquisitions, acquisition/traits.hpp) and the restarts
+  // are refined concurrently on the thread pool, sharing
+  // the model read only; the best maximum wins.
+  template <class Acq, class Opt>
+  auto maximize(
+      const Acq& acq,  //
+      const Opt& opt,  //
+      starts_t starts) const -> input_t {
+    auto x = std::move(starts.candidates);
+    if constexpr (acquisition::is_batched_v<Acq, input_t>) {
+      const auto score = screen(acq, x, starts.deadline);
+      x.resize(score.size());
+      const auto top = std::min(top_, x.size());
+      auto order = std::vector<size_t>(x.size());
+      std::iota(std::begin(order), std::end(order), 0);
+      std::partial_sort(
+          std::begin(order),
+          std::begin(order) + top,
+          std::end(order),
+          [&score](auto i, auto j) {
+            return score[i] > score[j];
+          });
+      auto kept = std::vector<input_t>{};
+      kept.reserve(top);
+      for (std::size_t i = 0; i < top; ++i) {
+        kept.emplace_back(x[order[i]]);
+      }
+      x = std::move(kept);
+    } else {
+      x.clear();
+    }
+    auto& streams = starts.streams;
+    const auto screened = x.size();
+    x.resize(screened + streams.size());
+    thread_pool::instance().parallel_for(
+        x.size(), [&](std::size_t i) {
+          const auto x_gen =
+              (i < screened)
+                  ? x[i]
+                  : streams[i - screened].generate(
+                        starts.center);
+          const auto& domain = *starts.domain;
+          x[i] = domain.project(opt.maximize(x_gen));
+        });
+    auto value = std::vector<number_t>{};
+    if constexpr (acquisition::is_batched_v<Acq, input_t>) {
+      value = acq.score(x);
+    } else {
+      for (const auto& xi : x) {
+        value.emplace_back(acq(xi));
+      }
+    }
+    const auto best = std::max_element(
+        std::cbegin(value), std::cend(value));
+    return x[std::distance(std::cbegin(value), best)];
   }
 
  private:
+  static constexpr auto kTop = size_t{4};
+  static constexpr auto kChunk = size_t{256};
+  static constexpr auto kMinCost = number_t{1e-9};
+  static constexpr auto kUnlimited =
+      std::numeric_limits<number_t>::infinity();
+  static constexpr auto kTolerance = number_t{1e-9};
+  static constexpr auto kRetries = size_t{2};
+  static constexpr auto kLengthInit = number_t{0.8};
+  static constexpr auto kLengthMin = number_t{0.0078125};
+  static constexpr auto kLengthMax = number_t{1.6};
+  static constexpr auto kSuccesses = size_t{3};
+  static constexpr auto kFailures = size_t{4};
+  static constexpr auto kImprovement = number_t{1e-3};
+  static constexpr auto kUnknown =
+      std::numeric_limits<number_t>::quiet_NaN();
+
   Model model_;
+  Model cost_;
+  classifier_t feasible_;
   Domain domain_;
   Functor functor_;
+  journal_t journal_;
+  cache_t cache_{kTolerance};
+  Observer observer_;
   sample_t best_;
+  size_t candidates_{0};
+  size_t top_{kTop};
+  size_t restarts_{1};
+  number_t spent_{0};
+  number_t offset_{0};
+  number_t budget_{kUnlimited};
+  b2o::latency latency_;
+  std::vector<region_t> regions_;
+  std::vector<sample_t> stale_;
+  std::vector<number_t> stale_noise_;
+  std::vector<bool> partial_;  ///< Stopped, cache order
+  stopping_t stopping_;
 };
 
 }  // namespace b2o::optimization
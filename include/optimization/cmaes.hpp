@@ -0,0 +1,382 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "acquisition/traits.hpp"
+#include "helpers/clock.hpp"
+#include "helpers/logging.hpp"
+#include "helpers/thread_pool.hpp"
+#include "solver/cholesky.hpp"
+
+namespace b2o::optimization {
+
+/// @brief Configuration for the CMA-ES optimizer
+template <class Number>
+struct cmaes_config {
+  using number_t = Number;
+
+  std::size_t generations{100};  ///< Maximum generations
+  number_t sigma{0.3};           ///< Initial step (boxes)
+  std::size_t population{0};     ///< Lambda, 0 for default
+  number_t tol{1e-8};            ///< Step size tolerance
+  b2o::deadline deadline;        ///< Stop, best so far
+  std::uint64_t seed{0};         ///< Sampling seed
+};
+
+template <class Number>
+cmaes_config(std::size_t, Number)
+    -> cmaes_config<Number>;
+
+/// @brief Covariance matrix adaptation evolution strategy
+///
+/// Derivative free: every generation samples lambda points
+///
+///   x_k = m + sigma * A * z_k ,  z_k ~ N(0, I) ,
+///   C   = A A.T (Cholesky) ,
+///
+/// ranks them by value and moves the mean, the evolution
+/// paths, the covariance C and the step size sigma with the
+/// standard (Hansen) weights and rates. Populations are
+/// evaluated by value only, in chunks across the thread
+/// pool, through score(x) for batched acquisitions
+/// (acquisition/traits.hpp). With bounds the initial
+/// covariance follows the box widths, points are evaluated
+/// at their projection and pay a quadratic penalty for the
+/// distance to it. The best point seen is returned. The
+/// samples of a run come from a generator seeded by the
+/// configuration and the start, so runs are reproducible
+/// (the starts drawn from a seeded domain) and concurrent
+/// runs from other starts draw other samples.
+/// @tparam Functor Objective function type
+/// @tparam Number Numeric type
+/// @tparam Observer Iteration log (helpers/logging.hpp)
+template <
+    class Functor,
+    class Number,
+    class Observer = logging::none>
+class cmaes {
+  using Vector = std::vector<Number>;
+  using Matrix = std::vector<Vector>;
+
+  static constexpr auto kPenalty = Number{1e3};
+  static constexpr auto kJitter = Number{1e-12};
+
+ public:
+  using number_t = Number;
+  using config_t = cmaes_config<Number>;
+  using range_t = std::pair<Number, Number>;
+
+  /// @brief Construct an unbounded optimizer
+  /// @param functor Objective function
+  /// @param config Optimizer configuration
+  template <class Fn>
+  explicit cmaes(Fn&& functor, const config_t& config)
+      : functor_{std::forward<Fn>(functor)},
+        config_{config} {
+  }
+
+  /// @brief Construct a bound constrained optimizer
+  /// @param functor Objective function
+  /// @param config Optimizer configuration
+  /// @param limits Per dimension (lower, upper) bounds
+  template <class Fn, class Limits>
+  cmaes(
+      Fn&& functor,
+      const config_t& config,
+      const Limits& limits)
+      : functor_{std::forward<Fn>(functor)},
+        config_{config},
+        limits_(std::cbegin(limits), std::cend(limits)) {
+  }
+
+  auto observer() const -> const Observer& {
+    return observer_;
+  }
+
+  /// @brief Minimize objective starting from x
+  /// @param x Initial mean
+  /// @return Best point found
+  template <class Input>
+  auto minimize(Input&& x) const {
+    return optimize(std::forward<Input>(x), Number{-1});
+  }
+
+  /// @brief Maximize objective starting from x
+  /// @param x Initial mean
+  /// @return Best point found
+  template <class Input>
+  auto maximize(Input&& x) const {
+    return optimize(std::forward<Input>(x), Number{1});
+  }
+
+ protected:
+  /// @brief Maximize sign * f from x
+  template <class Input>
+  auto optimize(Input x, Number sign) const -> Input {
+    const auto n = x.size();
+    const auto dim = static_cast<Number>(n);
+    const auto lambda = (config_.population > 0)
+                            ? config_.population
+                            : 4 + static_cast<std::size_t>(
+                                      3 * std::log(dim));
+    const auto mu = lambda / 2;
+
+    // weights and rates
+    auto w = Vector(mu);
+    for (std::size_t i = 0; i < mu; ++i) {
+      w[i] = std::log(Number(mu) + Number{0.5}) -
+             std::log(Number(i + 1));
+    }
+    const auto wsum = std::accumulate(
+        std::cbegin(w), std::cend(w), Number{0});
+    auto w2 = Number{0};
+    for (auto& wi : w) {
+      wi /= wsum;
+      w2 += wi * wi;
+    }
+    const auto mueff = Number{1} / w2;
+    const auto cc = (4 + mueff / dim) /
+                    (dim + 4 + 2 * mueff / dim);
+    const auto cs = (mueff + 2) / (dim + mueff + 5);
+    const auto c1 = 2 / ((dim + 1.3) * (dim + 1.3) + mueff);
+    const auto cmu = std::min(
+        1 - c1,
+        2 * (mueff - 2 + 1 / mueff) /
+            ((dim + 2) * (dim + 2) + mueff));
+    const auto damps =
+        1 + cs +
+        2 * std::max(
+                Number{0},
+                std::sqrt((mueff - 1) / (dim + 1)) - 1);
+    const auto chi = std::sqrt(dim) *
+                     (1 - 1 / (4 * dim) +
+                      1 / (21 * dim * dim));
+
+    // state
+    auto rng = generator(x);
+    auto normal = std::normal_distribution<Number>{};
+    auto m = Vector(std::cbegin(x), std::cend(x));
+    auto ps = Vector(n);
+    auto pc = Vector(n);
+    auto c = Matrix(n, Vector(n));
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto width = (i < limits_.size())
+                             ? limits_[i].second -
+                                   limits_[i].first
+                             : Number{1};
+      c[i][i] = width * width;
+    }
+    auto a = Matrix{};
+    factor_.build(c, a);
+    auto sigma = config_.sigma;
+    auto best = project(x);
+    auto best_value = sign * value(best);
+    observer_.vector("init", x);
+
+    auto z = Matrix(lambda, Vector(n));
+    auto y = Matrix(lambda, Vector(n));
+    auto points = std::vector<Input>(lambda);
+    auto order = std::vector<std::size_t>(lambda);
+    for (std::size_t g = 0; g < config_.generations; ++g) {
+      if (config_.deadline.expired()) {
+        break;
+      }
+      for (std::size_t k = 0; k < lambda; ++k) {
+        for (auto& zi : z[k]) {
+          zi = normal(rng);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+          auto sum = Number{0};
+          for (std::size_t j = 0; j <= i; ++j) {
+            sum += a[i][j] * z[k][j];
+          }
+          y[k][i] = sum;
+          points[k][i] = m[i] + sigma * sum;
+        }
+      }
+      const auto values = evaluate(points, sign);
+      std::iota(std::begin(order), std::end(order), 0);
+      std::sort(
+          std::begin(order),
+          std::end(order),
+          [&values](auto i, auto j) {
+            return values[i] > values[j];
+          });
+      if (values[order[0]] > best_value) {
+        best_value = values[order[0]];
+        best = project(points[order[0]]);
+      }
+      observer_.number("iter", g);
+      observer_.number("objective", sign * best_value);
+      observer_.number("sigma", sigma);
+
+      // mean and evolution paths
+      auto yw = Vector(n);
+      auto zw = Vector(n);
+      for (std::size_t r = 0; r < mu; ++r) {
+        const auto k = order[r];
+        for (std::size_t i = 0; i < n; ++i) {
+          yw[i] += w[r] * y[k][i];
+          zw[i] += w[r] * z[k][i];
+        }
+      }
+      const auto gs = std::sqrt(cs * (2 - cs) * mueff);
+      auto ps2 = Number{0};
+      for (std::size_t i = 0; i < n; ++i) {
+        m[i] += sigma * yw[i];
+        ps[i] = (1 - cs) * ps[i] + gs * zw[i];
+        ps2 += ps[i] * ps[i];
+      }
+      const auto norm = std::sqrt(ps2);
+      const auto decay = std::sqrt(
+          1 - std::pow(1 - cs, Number(2 * (g + 1))));
+      const auto hsig =
+          norm / decay / chi < 1.4 + 2 / (dim + 1);
+      const auto gc = std::sqrt(cc * (2 - cc) * mueff);
+      for (std::size_t i = 0; i < n; ++i) {
+        pc[i] = (1 - cc) * pc[i] + (hsig ? gc * yw[i] : 0);
+      }
+
+      // covariance (lower triangle) and step size
+      const auto keep = 1 - c1 - cmu +
+                        (hsig ? 0 : c1 * cc * (2 - cc));
+      for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j <= i; ++j) {
+          auto rank = Number{0};
+          for (std::size_t r = 0; r < mu; ++r) {
+            const auto k = order[r];
+            rank += w[r] * y[k][i] * y[k][j];
+          }
+          c[i][j] = keep * c[i][j] +
+                    c1 * pc[i] * pc[j] + cmu * rank;
+          c[j][i] = c[i][j];
+        }
+        c[i][i] += kJitter;
+      }
+      sigma *= std::exp((cs / damps) * (norm / chi - 1));
+      factor_.build(c, a);
+
+      auto spread = Number{0};
+      auto valid = true;
+      for (std::size_t i = 0; i < n; ++i) {
+        spread = std::max(spread, std::sqrt(c[i][i]));
+        valid = valid && a[i][i] > Number{0};
+      }
+      if (!valid || !(sigma * spread > config_.tol)) {
+        break;
+      }
+    }
+    return best;
+  }
+
+  /// @brief sign * f over a population with the box
+  /// penalty, in chunks across the thread pool
+  template <class Input>
+  auto evaluate(const std::vector<Input>& x, Number sign)
+      const -> Vector {
+    auto result = Vector(x.size());
+    auto& pool = thread_pool::instance();
+    const auto chunks = std::min(x.size(), pool.size() + 1);
+    pool.parallel_for(chunks, [&](std::size_t c) {
+      const auto beg = x.size() * c / chunks;
+      const auto end = x.size() * (c + 1) / chunks;
+      auto part = std::vector<Input>{};
+      for (auto i = beg; i < end; ++i) {
+        part.emplace_back(project(x[i]));
+      }
+      const auto values = score(part);
+      for (auto i = beg; i < end; ++i) {
+        const auto& p = part[i - beg];
+        result[i] = sign * values[i - beg] -
+                    kPenalty * distance(x[i], p);
+      }
+    });
+    return result;
+  }
+
+  /// @brief Value only f over points
+  template <class Input>
+  auto score(const std::vector<Input>& x) const -> Vector {
+    if constexpr (acquisition::is_batched_v<
+                      Functor,
+                      Input>) {
+      return functor_.score(x);
+    } else {
+      auto result = Vector{};
+      result.reserve(x.size());
+      for (const auto& xi : x) {
+        result.emplace_back(functor_(xi));
+      }
+      return result;
+    }
+  }
+
+  template <class Input>
+  auto value(const Input& x) const -> Number {
+    return score(std::vector<Input>{x}).front();
+  }
+
+  /// @brief Squared distance in box widths
+  template <class Input>
+  auto distance(const Input& x, const Input& p) const
+      -> Number {
+    auto sum = Number{0};
+    for (std::size_t i = 0; i < limits_.size(); ++i) {
+      const auto& [lo, hi] = limits_[i];
+      const auto d = (x[i] - p[i]) / (hi - lo);
+      sum += d * d;
+    }
+    return sum;
+  }
+
+  template <class Input>
+  auto project(Input x) const -> Input {
+    const auto n = std::min(x.size(), limits_.size());
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto& [lo, hi] = limits_[i];
+      x[i] = std::clamp(x[i], lo, hi);
+    }
+    return x;
+  }
+
+  // Generator of a run from x: the seed and the bits of
+  // the start
+  template <class Input>
+  auto generator(const Input& x) const -> std::mt19937_64 {
+    auto words = std::vector<std::uint32_t>{
+        static_cast<std::uint32_t>(config_.seed),
+        static_cast<std::uint32_t>(config_.seed >> 32)};
+    for (const auto& xi : x) {
+      auto bits = std::uint64_t{0};
+      const auto size = std::min(sizeof(xi), sizeof(bits));
+      std::memcpy(&bits, &xi, size);
+      words.emplace_back(static_cast<std::uint32_t>(bits));
+      words.emplace_back(
+          static_cast<std::uint32_t>(bits >> 32));
+    }
+    auto seed =
+        std::seed_seq(std::cbegin(words), std::cend(words));
+    return std::mt19937_64{seed};
+  }
+
+ private:
+  Functor functor_;              ///< Objective function
+  config_t config_;              ///< Configuration
+  std::vector<range_t> limits_;  ///< Bounds, empty if none
+  math::cholesky<Number> factor_;
+  Observer observer_;            ///< Iteration log
+};
+
+template <class Functor, class Number>
+cmaes(Functor, const cmaes_config<Number>&)
+    -> cmaes<Functor, Number>;
+
+}  // namespace b2o::optimization
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace b2o::optimization {
+
+/// @brief Objective at one fidelity level
+/// @tparam Number Numeric type
+/// @tparam Functor Objective of the inputs x
+template <class Number, class Functor>
+struct fidelity {
+  Number level;     ///< Fidelity, the highest is the target
+  Number cost;      ///< Cost per evaluation (any unit)
+  Functor functor;  ///< Objective at this fidelity
+};
+
+template <class Number, class Functor>
+fidelity(Number, Number, Functor)
+    -> fidelity<Number, Functor>;
+
+/// @brief Multi-fidelity objective of (x, s)
+///
+/// The last input coordinate s selects the fidelity (the
+/// nearest level), the others are the inputs x of its
+/// functor. The model sees (x, s) as one input, so a kernel
+/// with its own length scale on s (ARD) correlates the
+/// fidelities; bayesian::run_fidelity picks s per step.
+/// @tparam Number Numeric type
+/// @tparam Functors Objectives, one per level
+template <class Number, class... Functors>
+class fidelities {
+  static constexpr auto kLevels = sizeof...(Functors);
+
+ public:
+  using number_t = Number;
+  using levels_t = std::array<Number, kLevels>;
+
+  explicit fidelities(fidelity<Number, Functors>... f)
+      : levels_{f.level...},
+        costs_{f.cost...},
+        functors_{std::move(f.functor)...} {
+  }
+
+  auto levels() const -> const levels_t& {
+    return levels_;
+  }
+
+  auto costs() const -> const levels_t& {
+    return costs_;
+  }
+
+  /// @brief The highest level
+  auto target() const -> Number {
+    auto top = levels_[0];
+    for (const auto level : levels_) {
+      top = std::max(top, level);
+    }
+    return top;
+  }
+
+  template <class Input>
+  auto operator()(const Input& xs) {
+    constexpr auto n = std::tuple_size_v<Input> - 1;
+    auto x = std::array<typename Input::value_type, n>{};
+    for (std::size_t d = 0; d < n; ++d) {
+      x[d] = xs[d];
+    }
+    auto m = std::size_t{0};
+    for (std::size_t i = 1; i < kLevels; ++i) {
+      if (std::abs(levels_[i] - xs[n]) <
+          std::abs(levels_[m] - xs[n])) {
+        m = i;
+      }
+    }
+    return call(
+        m, x, std::index_sequence_for<Functors...>{});
+  }
+
+ protected:
+  // y = functor m (x)
+  template <class X, std::size_t... I>
+  auto call(
+      std::size_t m,
+      const X& x,
+      std::index_sequence<I...>) -> Number {
+    auto y = Number{0};
+    const auto at = [&](auto& functor, std::size_t i) {
+      if (i == m) {
+        y = functor(x);
+      }
+    };
+    (at(std::get<I>(functors_), I), ...);
+    return y;
+  }
+
+ private:
+  levels_t levels_;
+  levels_t costs_;
+  std::tuple<Functors...> functors_;
+};
+
+template <class Number, class... Functors>
+fidelities(fidelity<Number, Functors>...)
+    -> fidelities<Number, Functors...>;
+
+}  // namespace b2o::optimization
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <limits>
 #include <utility>
 
 #include "dual/number.hpp"
+#include "helpers/clock.hpp"
 #include "helpers/functional.hpp"
+#include "helpers/logging.hpp"
 
 namespace b2o::optimization {
 
@@ -15,6 +18,7 @@ struct gradient_config {
   std::size_t steps{100};  ///< Maximum number of iterations
   number_t rate{1e-2};     ///< Learning rate
   number_t eps{1e-6};      ///< Minimum step size
+  b2o::deadline deadline;  ///< Stop with the best so far
 };
 
 template <class Number>
@@ -25,7 +29,11 @@ gradient_config(std::size_t, Number, Number)
 /// autodiff
 /// @tparam Functor Objective function type
 /// @tparam Number Numeric type
-template <class Functor, class Number>
+/// @tparam Observer Iteration log (helpers/logging.hpp)
+template <
+    class Functor,
+    class Number,
+    class Observer = logging::none>
 class gradient {
  public:
   using number_t = Number;
@@ -40,6 +48,10 @@ class gradient {
         config_{config} {
   }
 
+  auto observer() const -> const Observer& {
+    return observer_;
+  }
+
   /// @brief Minimize objective starting from x
   /// @param x Initial point
   /// @return Optimized point
@@ -49,7 +61,8 @@ class gradient {
     const auto step = [this](auto& n, auto dv) {
       n -= config_.rate * dv;
     };
-    return optimize(std::forward<Input>(x), step);
+    return optimize(
+        std::forward<Input>(x), step, Number{-1});
   }
 
   /// @brief Maximize objective starting from x
@@ -61,12 +74,16 @@ class gradient {
     const auto step = [this](auto& n, auto dv) {
       n += config_.rate * dv;
     };
-    return optimize(std::forward<Input>(x), step);
+    return optimize(
+        std::forward<Input>(x), step, Number{1});
   }
 
  protected:
+  // Anytime: past the deadline, the best evaluated point
+  // (sign * f) is returned instead of the last iterate
   template <class Input, class Step>
-  auto optimize(Input x, Step step) const -> Input {
+  auto optimize(Input x, Step step, Number sign) const
+      -> Input {
     // Lambda to check convergence
     const auto done = [this](auto dv) {
       return std::abs(dv) < config_.eps;
@@ -75,14 +92,24 @@ class gradient {
     const auto seed = [](auto& dn, auto vn) {
       dn.value(vn);
     };
-    print_vector("init", x);
+    observer_.vector("init", x);
+    auto best = x;
+    auto best_value =
+        -std::numeric_limits<Number>::infinity();
     auto dinput = dual::make_array(x);
     for (std::size_t s = 0; s < config_.steps; ++s) {
+      if (config_.deadline.expired()) {
+        return best;
+      }
       const auto dresult = functor_(dinput);
+      if (sign * dresult.value() > best_value) {
+        best_value = sign * dresult.value();
+        best = x;
+      }
       each(step, x, dresult.dvalue());
-      print_number("iter", s);
-      print_number("objective", dresult.value());
-      print_vector("gradient", dresult.dvalue());
+      observer_.number("iter", s);
+      observer_.number("objective", dresult.value());
+      observer_.vector("gradient", dresult.dvalue());
       if (all(done, dresult.dvalue()))
         break;
       each(seed, dinput, x);
@@ -91,8 +118,9 @@ class gradient {
   }
 
  private:
-  Functor functor_;  ///< Objective function
-  config_t config_;  ///< Gradient configuration
+  Functor functor_;    ///< Objective function
+  config_t config_;    ///< Gradient configuration
+  Observer observer_;  ///< Iteration log
 };
 
 template <class Functor, class Number>
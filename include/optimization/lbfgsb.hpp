@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "dual/number.hpp"
+#include "helpers/clock.hpp"
+#include "helpers/logging.hpp"
+
+namespace b2o::optimization {
+
+/// @brief Configuration for the L-BFGS-B optimizer
+template <class Number>
+struct lbfgsb_config {
+  using number_t = Number;
+
+  std::size_t steps{100};  ///< Maximum iterations
+  number_t eps{1e-6};      ///< Projected gradient tolerance
+  std::size_t memory{6};   ///< Curvature pairs kept
+  number_t ftol{1e-10};    ///< Relative decrease tolerance
+  b2o::deadline deadline;  ///< Stop with the best so far
+};
+
+template <class Number>
+lbfgsb_config(std::size_t, Number)
+    -> lbfgsb_config<Number>;
+
+/// @brief Bound constrained limited memory BFGS using
+/// forward-mode autodiff
+///
+/// Projected variant of L-BFGS-B: variables at a bound with
+/// the gradient pushing outwards are fixed, the two-loop
+/// recursion over the last `memory` pairs (s, y) gives the
+/// direction d on the free ones, and a weak Wolfe line
+/// search runs along the projected path
+///
+///   x(a) = P(x + a d) ,  P = clamp to the bounds ,
+///
+/// so every evaluation is feasible. It stops when the
+/// projected gradient |P(x - g) - x| or the relative
+/// decrease of f falls below the tolerances, or past the
+/// deadline (x only ever decreases f, it is the best so
+/// far).
+/// @tparam Functor Objective function type
+/// @tparam Number Numeric type
+/// @tparam Observer Iteration log (helpers/logging.hpp)
+template <
+    class Functor,
+    class Number,
+    class Observer = logging::none>
+class lbfgsb {
+  static constexpr auto kArmijo = Number{1e-4};
+  static constexpr auto kCurvature = Number{0.9};
+  static constexpr auto kSearch = std::size_t{20};
+  static constexpr auto kInfinity =
+      std::numeric_limits<Number>::infinity();
+
+ public:
+  using number_t = Number;
+  using config_t = lbfgsb_config<Number>;
+  using range_t = std::pair<Number, Number>;
+
+  /// @brief Construct an unbounded optimizer
+  /// @param functor Objective function
+  /// @param config Optimizer configuration
+  template <class Fn>
+  explicit lbfgsb(Fn&& functor, const config_t& config)
+      : functor_{std::forward<Fn>(functor)},
+        config_{config} {
+  }
+
+  /// @brief Construct a bound constrained optimizer
+  /// @param functor Objective function
+  /// @param config Optimizer configuration
+  /// @param limits Per dimension (lower, upper) bounds
+  template <class Fn, class Limits>
+  lbfgsb(
+      Fn&& functor,
+      const config_t& config,
+      const Limits& limits)
+      : functor_{std::forward<Fn>(functor)},
+        config_{config},
+        limits_(std::cbegin(limits), std::cend(limits)) {
+  }
+
+  auto observer() const -> const Observer& {
+    return observer_;
+  }
+
+  /// @brief Minimize objective starting from x
+  /// @param x Initial point
+  /// @return Optimized point
+  template <class Input>
+  auto minimize(Input&& x) const {
+    return optimize(std::forward<Input>(x), Number{1});
+  }
+
+  /// @brief Maximize objective starting from x
+  /// @param x Initial point
+  /// @return Optimized point
+  template <class Input>
+  auto maximize(Input&& x) const {
+    return optimize(std::forward<Input>(x), Number{-1});
+  }
+
+ protected:
+  /// @brief Minimize sign * f from x
+  template <class Input>
+  auto optimize(Input x, Number sign) const -> Input {
+    auto pairs = std::deque<std::pair<Input, Input>>{};
+    x = project(x);
+    observer_.vector("init", x);
+    auto [f, g] = evaluate(x, sign);
+    for (std::size_t s = 0; s < config_.steps; ++s) {
+      observer_.number("iter", s);
+      observer_.number("objective", sign * f);
+      observer_.vector("gradient", g);
+      if (projected_norm(x, g) < config_.eps ||
+          config_.deadline.expired()) {
+        break;
+      }
+      auto d = direction(x, g, pairs);
+      auto slope = dot(g, d);
+      if (!(slope < Number{0})) {
+        pairs.clear();
+        d = direction(x, g, pairs);
+        slope = dot(g, d);
+      }
+      // first step of the gradient direction: unit length
+      auto a = pairs.empty()
+                   ? Number{1} / std::sqrt(dot(g, g))
+                   : Number{1};
+      auto lo = Number{0};
+      auto hi = kInfinity;
+      auto xn = x;
+      auto fn = f;
+      auto gn = g;
+      for (std::size_t t = 0; t < kSearch; ++t) {
+        xn = step(x, d, a);
+        std::tie(fn, gn) = evaluate(xn, sign);
+        const auto decrease = dot(g, difference(xn, x));
+        if (fn > f + kArmijo * decrease) {
+          hi = a;
+        } else if (
+            !clipped(x, d, a, xn) &&
+            dot(gn, d) < kCurvature * slope) {
+          lo = a;
+        } else {
+          break;
+        }
+        a = (hi < kInfinity) ? (lo + hi) / Number{2}
+                             : Number{2} * a;
+      }
+      if (!(fn < f)) {
+        break;
+      }
+      const auto s_k = difference(xn, x);
+      const auto y_k = difference(gn, g);
+      if (dot(s_k, y_k) >
+          std::numeric_limits<Number>::epsilon() *
+              dot(y_k, y_k)) {
+        pairs.emplace_back(s_k, y_k);
+        if (pairs.size() > config_.memory) {
+          pairs.pop_front();
+        }
+      }
+      const auto scale = std::max(
+          {std::abs(f), std::abs(fn), Number{1}});
+      const auto done = (f - fn) <= config_.ftol * scale;
+      x = xn;
+      f = fn;
+      g = gn;
+      if (done) {
+        break;
+      }
+    }
+    return x;
+  }
+
+  /// @brief Value and gradient of sign * f at x
+  template <class Input>
+  auto evaluate(const Input& x, Number sign) const
+      -> std::pair<Number, Input> {
+    const auto result = functor_(dual::make_array(x));
+    const auto& dvalue = result.dvalue();
+    auto g = Input{};
+    for (std::size_t i = 0; i < g.size(); ++i) {
+      g[i] = (i < dvalue.size()) ? sign * dvalue[i]
+                                 : Number{0};
+    }
+    return {sign * result.value(), g};
+  }
+
+  /// @brief Two-loop recursion on the free variables
+  template <class Input, class Pairs>
+  auto direction(
+      const Input& x,
+      const Input& g,
+      const Pairs& pairs) const -> Input {
+    const auto free = [&](std::size_t i) {
+      if (i >= limits_.size()) {
+        return true;
+      }
+      const auto& [lo, hi] = limits_[i];
+      return !((x[i] <= lo && g[i] > Number{0}) ||
+               (x[i] >= hi && g[i] < Number{0}));
+    };
+    auto q = g;
+    for (std::size_t i = 0; i < q.size(); ++i) {
+      q[i] = free(i) ? q[i] : Number{0};
+    }
+    auto alpha = std::vector<Number>(pairs.size());
+    for (std::size_t k = pairs.size(); k-- > 0;) {
+      const auto& [s, y] = pairs[k];
+      alpha[k] = dot(s, q) / dot(s, y);
+      for (std::size_t i = 0; i < q.size(); ++i) {
+        q[i] -= alpha[k] * y[i];
+      }
+    }
+    if (!pairs.empty()) {
+      const auto& [s, y] = pairs.back();
+      const auto gamma = dot(s, y) / dot(y, y);
+      for (auto& qi : q) {
+        qi *= gamma;
+      }
+    }
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+      const auto& [s, y] = pairs[k];
+      const auto beta = dot(y, q) / dot(s, y);
+      for (std::size_t i = 0; i < q.size(); ++i) {
+        q[i] += (alpha[k] - beta) * s[i];
+      }
+    }
+    for (std::size_t i = 0; i < q.size(); ++i) {
+      q[i] = free(i) ? -q[i] : Number{0};
+    }
+    return q;
+  }
+
+  /// @brief |P(x - g) - x| (max norm)
+  template <class Input>
+  auto projected_norm(const Input& x, const Input& g) const
+      -> Number {
+    const auto p = difference(project(difference(x, g)), x);
+    auto norm = Number{0};
+    for (const auto& pi : p) {
+      norm = std::max(norm, std::abs(pi));
+    }
+    return norm;
+  }
+
+  template <class Input>
+  auto step(const Input& x, const Input& d, Number a) const
+      -> Input {
+    auto result = x;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      result[i] += a * d[i];
+    }
+    return project(result);
+  }
+
+  /// @brief Whether the projection cut the step x + a d
+  template <class Input>
+  static auto clipped(
+      const Input& x,
+      const Input& d,
+      Number a,
+      const Input& xn) -> bool {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      if (xn[i] != x[i] + a * d[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <class Input>
+  auto project(Input x) const -> Input {
+    const auto n = std::min(x.size(), limits_.size());
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto& [lo, hi] = limits_[i];
+      x[i] = std::clamp(x[i], lo, hi);
+    }
+    return x;
+  }
+
+  template <class Input>
+  static auto difference(const Input& a, const Input& b)
+      -> Input {
+    auto result = a;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      result[i] -= b[i];
+    }
+    return result;
+  }
+
+  template <class Input>
+  static auto dot(const Input& a, const Input& b)
+      -> Number {
+    auto sum = Number{0};
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      sum += a[i] * b[i];
+    }
+    return sum;
+  }
+
+ private:
+  Functor functor_;              ///< Objective function
+  config_t config_;              ///< Configuration
+  std::vector<range_t> limits_;  ///< Bounds, empty if none
+  Observer observer_;            ///< Iteration log
+};
+
+template <class Functor, class Number>
+lbfgsb(Functor, const lbfgsb_config<Number>&)
+    -> lbfgsb<Functor, Number>;
+
+}  // namespace b2o::optimization
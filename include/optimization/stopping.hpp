@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace b2o::optimization {
+
+/// @brief Median stopping rule of iterative objectives
+///
+/// Objectives taking a trial, f(x, trial), report their
+/// intermediate values (lower is better) with
+/// trial.report(y) and stop as soon as it returns false,
+/// returning their last value. A trial is stopped at step
+/// t when its best value so far is worse than the median,
+/// over the completed trials reaching step t, of their
+/// running average up to t:
+///
+///   min_{s <= t} y_s > median_k mean_{s <= t} y^k_s ,
+///
+/// once past `grace` steps and `trials` completed trials.
+/// Stopped trials stay out of the history (the optimizer
+/// models their last value as a low-fidelity sample, see
+/// bayesian::early_stopping). Thread safe, one trial per
+/// evaluation.
+/// @tparam Number Numeric type
+template <class Number>
+class median_stopping {
+  static constexpr auto kGrace = std::size_t{1};
+  static constexpr auto kTrials = std::size_t{5};
+
+ public:
+  /// @brief Intermediate reports of one evaluation
+  class trial {
+   public:
+    explicit trial(median_stopping& rule) : rule_{rule} {
+    }
+
+    trial(const trial&) = delete;
+    auto operator=(const trial&) -> trial& = delete;
+
+    ~trial() {
+      rule_.finish(std::move(values_), stopped_);
+    }
+
+    /// @brief Report the next intermediate value
+    /// @return false once the evaluation should stop
+    auto report(Number y) -> bool {
+      best_ = values_.empty() ? y : std::min(best_, y);
+      values_.emplace_back(y);
+      stopped_ =
+          stopped_ || rule_.stop(values_.size(), best_);
+      return !stopped_;
+    }
+
+    auto stopped() const -> bool {
+      return stopped_;
+    }
+
+   private:
+    median_stopping& rule_;
+    std::vector<Number> values_;
+    Number best_{0};
+    bool stopped_{false};
+  };
+
+  /// @param grace Steps never stopped
+  /// @param trials Completed trials before stopping any
+  explicit median_stopping(
+      std::size_t grace = kGrace,
+      std::size_t trials = kTrials)
+      : grace_{grace}, trials_{trials} {
+  }
+
+  median_stopping(median_stopping&& other) noexcept
+      : grace_{other.grace_},
+        trials_{other.trials_},
+        curves_{std::move(other.curves_)},
+        stopped_{other.stopped_} {
+  }
+
+  auto configure(std::size_t grace, std::size_t trials)
+      -> void {
+    const auto lock = std::lock_guard{mutex_};
+    grace_ = grace;
+    trials_ = trials;
+  }
+
+  /// @brief Number of stopped trials
+  auto stopped() const -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return stopped_;
+  }
+
+ protected:
+  // Median over the completed curves reaching step t
+  auto stop(std::size_t t, Number best) const -> bool {
+    const auto lock = std::lock_guard{mutex_};
+    if (t <= grace_ || curves_.size() < trials_) {
+      return false;
+    }
+    auto values = std::vector<Number>{};
+    for (const auto& curve : curves_) {
+      if (curve.size() >= t) {
+        values.emplace_back(curve[t - 1]);
+      }
+    }
+    if (values.size() < trials_) {
+      return false;
+    }
+    const auto mid = std::begin(values) + values.size() / 2;
+    std::nth_element(
+        std::begin(values), mid, std::end(values));
+    return best > *mid;
+  }
+
+  // Completed curves kept as running averages
+  auto finish(std::vector<Number> values, bool stopped)
+      -> void {
+    const auto lock = std::lock_guard{mutex_};
+    if (stopped) {
+      ++stopped_;
+      return;
+    }
+    if (values.empty()) {
+      return;
+    }
+    auto sum = Number{0};
+    for (std::size_t s = 0; s < values.size(); ++s) {
+      sum += values[s];
+      values[s] = sum / Number(s + 1);
+    }
+    curves_.emplace_back(std::move(values));
+  }
+
+ private:
+  std::size_t grace_;
+  std::size_t trials_;
+  std::vector<std::vector<Number>> curves_;
+  std::size_t stopped_{0};
+  mutable std::mutex mutex_;
+};
+
+}  // namespace b2o::optimization
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "helpers/clock.hpp"
+#include "helpers/logging.hpp"
+#include "optimization/bayesian.hpp"
+
+namespace b2o::optimization {
+
+namespace detail {
+
+/// @brief Objective of ask/tell studies, evaluated
+/// elsewhere (never called)
+template <class Number>
+struct untold {
+  template <class Input>
+  auto operator()(const Input&) const -> Number {
+    assert(false);
+    return std::numeric_limits<Number>::quiet_NaN();
+  }
+};
+
+}  // namespace detail
+
+/// @brief Ask/tell Bayesian optimization
+///
+/// The objective is evaluated by the caller (other
+/// processes, other machines): ask() hands out an input and
+/// its ticket, tell(ticket, y) brings the result back, in
+/// any order. Both are thread safe and cheap: a background
+/// worker owns the model, ingests the told results and
+/// keeps a queue of `depth` proposals ready, each one
+/// conditioned on the inputs still outstanding and queued
+/// (see bayesian::fantasy). ask() only waits when the queue
+/// is empty. The evaluation cost of a result (cost-aware
+/// acquisitions) is the time from its ask to its tell.
+/// An exception of the worker (model update or proposal)
+/// stops it; ask() rethrows it once the queue is empty.
+template <
+    template <class...> class Acquisition,
+    template <class...> class Optimizer,
+    class Model,
+    class Domain,
+    class Observer = logging::none,
+    class OptimizerObserver = logging::none>
+class study
+    : protected bayesian<
+          Acquisition,
+          Optimizer,
+          Model,
+          Domain,
+          detail::untold<typename Model::number_t>,
+          Observer,
+          OptimizerObserver> {
+  using base_t = bayesian<
+      Acquisition,
+      Optimizer,
+      Model,
+      Domain,
+      detail::untold<typename Model::number_t>,
+      Observer,
+      OptimizerObserver>;
+
+  static constexpr auto kDepth = std::size_t{2};
+
+ public:
+  using typename base_t::config_t;
+  using typename base_t::fantasy;
+  using typename base_t::input_t;
+  using typename base_t::journal_t;
+  using typename base_t::number_t;
+  using typename base_t::sample_t;
+  using ticket_t = std::size_t;
+  using asked_t = std::pair<ticket_t, input_t>;
+
+  /// @param config Optimizer configuration per proposal
+  /// @param depth Proposals kept ready (at least one)
+  /// @param lie Fantasized observations of pending inputs
+  /// @param journal Evaluation journal
+  /// (helpers/journal.hpp), its samples are resumed
+  /// (open failures throw while constructing it)
+  study(
+      Model model,
+      Domain domain,
+      config_t config,
+      std::size_t depth = kDepth,
+      fantasy lie = fantasy::mean,
+      journal_t journal = {})
+      : base_t{
+            std::move(model),
+            std::move(domain),
+            {},
+            typename base_t::deferred_t{},
+            std::move(journal)},
+        config_{config},
+        depth_{std::max(depth, std::size_t{1})},
+        lie_{lie},
+        snapshot_{base_t::best()},
+        size_{base_t::model().size()},
+        worker_{[this] { work(); }} {
+  }
+
+  study(const study&) = delete;
+  auto operator=(const study&) -> study& = delete;
+
+  ~study() {
+    {
+      const auto lock = std::lock_guard{mutex_};
+      stop_ = true;
+    }
+    wake_.notify_all();
+    ready_.notify_all();
+    worker_.join();
+  }
+
+  /// @brief Next input to evaluate and its ticket
+  /// @throw The exception of the worker, std::runtime_error
+  /// if the study stops meanwhile
+  auto ask() -> asked_t {
+    auto lock = std::unique_lock{mutex_};
+    ready_.wait(lock, [this] {
+      return !queue_.empty() || error_ || stop_;
+    });
+    if (queue_.empty()) {
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+      throw std::runtime_error{"study stopped"};
+    }
+    auto x = std::move(queue_.front());
+    queue_.pop_front();
+    const auto ticket = next_++;
+    outstanding_.emplace(ticket, ask_t{x, stopwatch{}});
+    lock.unlock();
+    wake_.notify_one();
+    return {ticket, std::move(x)};
+  }
+
+  /// @brief Result of an asked input
+  /// @return false for unknown or already told tickets
+  auto tell(ticket_t ticket, number_t y) -> bool {
+    {
+      const auto lock = std::lock_guard{mutex_};
+      const auto it = outstanding_.find(ticket);
+      if (it == std::end(outstanding_)) {
+        return false;
+      }
+      const auto& [x, watch] = it->second;
+      inbox_.emplace_back(x, y);
+      costs_.emplace_back(watch.elapsed());
+      outstanding_.erase(it);
+    }
+    wake_.notify_one();
+    return true;
+  }
+
+  /// @brief Best sample ingested so far
+  auto best() const -> sample_t {
+    const auto lock = std::lock_guard{mutex_};
+    return snapshot_;
+  }
+
+  /// @brief Asked inputs not told yet
+  auto outstanding() const -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return outstanding_.size();
+  }
+
+  /// @brief Samples in the model
+  auto size() const -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return size_;
+  }
+
+  /// @brief Whether the ingested results reached the
+  /// journal (false after a failed flush, until the next
+  /// ingest succeeds)
+  auto journaled() const -> bool {
+    const auto lock = std::lock_guard{mutex_};
+    return journaled_;
+  }
+
+ protected:
+  struct ask_t {
+    input_t x;
+    stopwatch watch;
+  };
+
+  // Background worker: ingest the told results first (also
+  // when stopping, so they reach the journal), then refill
+  // the queue of proposals. It stops on an exception, kept
+  // for ask() to rethrow.
+  auto work() -> void {
+    auto lock = std::unique_lock{mutex_};
+    while (true) {
+      wake_.wait(lock, [this] {
+        return stop_ || !inbox_.empty() ||
+               queue_.size() < depth_;
+      });
+      if (!inbox_.empty()) {
+        const auto samples = std::move(inbox_);
+        const auto costs = std::move(costs_);
+        inbox_.clear();
+        costs_.clear();
+        lock.unlock();
+        auto journaled = false;
+        try {
+          journaled = this->ingest(samples, costs);
+        } catch (...) {
+          return fail(lock);
+        }
+        const auto best = base_t::best();
+        const auto size = base_t::model().size();
+        lock.lock();
+        snapshot_ = best;
+        size_ = size;
+        journaled_ = journaled;
+        continue;
+      }
+      if (stop_) {
+        return;
+      }
+      auto pending = std::vector<input_t>{};
+      for (const auto& [_, ask] : outstanding_) {
+        pending.emplace_back(ask.x);
+      }
+      pending.insert(
+          std::end(pending),
+          std::cbegin(queue_),
+          std::cend(queue_));
+      lock.unlock();
+      auto x = input_t{};
+      try {
+        x = this->fantasize(pending, config_, lie_);
+      } catch (...) {
+        return fail(lock);
+      }
+      lock.lock();
+      queue_.emplace_back(std::move(x));
+      ready_.notify_one();
+    }
+  }
+
+  // Keep the current exception of the (unlocked) worker
+  // and wake the askers
+  auto fail(std::unique_lock<std::mutex>& lock) -> void {
+    const auto error = std::current_exception();
+    lock.lock();
+    error_ = error;
+    ready_.notify_all();
+  }
+
+ private:
+  config_t config_;
+  std::size_t depth_;
+  fantasy lie_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;   ///< Worker wakeup
+  std::condition_variable ready_;  ///< Queue refilled
+  std::deque<input_t> queue_;
+  std::map<ticket_t, ask_t> outstanding_;
+  std::vector<sample_t> inbox_;
+  std::vector<number_t> costs_;
+  sample_t snapshot_;
+  std::size_t size_;
+  bool journaled_{true};
+  ticket_t next_{0};
+  bool stop_{false};
+  std::exception_ptr error_;  ///< Of the stopped worker
+  std::thread worker_;  ///< Last, started once ready
+};
+
+}  // namespace b2o::optimization
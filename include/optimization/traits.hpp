@@ -0,0 +1,113 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "helpers/clock.hpp"
+
+namespace b2o::optimization {
+
+/// @brief Bounded optimizers
+///
+/// An optimizer is bounded when it can be built with the
+/// limits of the domain, Optimizer{f, config,
+/// domain.config()}, and then keeps its iterates inside
+/// them (e.g. lbfgsb). Others get Optimizer{f, config}
+/// and their result is projected afterwards.
+template <
+    class Optimizer,
+    class Functor,
+    class Config,
+    class Domain,
+    class = void>
+struct is_bounded : std::false_type {};
+
+template <
+    class Optimizer,
+    class Functor,
+    class Config,
+    class Domain>
+struct is_bounded<
+    Optimizer,
+    Functor,
+    Config,
+    Domain,
+    std::void_t<decltype(Optimizer{
+        std::declval<const Functor&>(),
+        std::declval<const Config&>(),
+        std::declval<const Domain&>().config()})>>
+    : std::true_type {};
+
+template <
+    class Optimizer,
+    class Functor,
+    class Config,
+    class Domain>
+inline constexpr auto is_bounded_v =
+    is_bounded<Optimizer, Functor, Config, Domain>::value;
+
+/// @brief Anytime optimizer configurations
+///
+/// A configuration is anytime when it carries a
+/// b2o::deadline (helpers/clock.hpp): past it the optimizer
+/// stops and returns its best point so far.
+template <class Config, class = void>
+struct is_anytime : std::false_type {};
+
+template <class Config>
+struct is_anytime<
+    Config,
+    std::void_t<decltype(std::declval<Config&>().deadline =
+                             b2o::deadline{})>>
+    : std::true_type {};
+
+template <class Config>
+inline constexpr auto is_anytime_v =
+    is_anytime<Config>::value;
+
+/// @brief Multi-fidelity objectives
+///
+/// An objective is multi-fidelity when it lists its
+/// fidelity levels and their costs (see
+/// optimization/fidelity.hpp), the fidelity being the last
+/// input coordinate.
+template <class Functor, class = void>
+struct is_multi_fidelity : std::false_type {};
+
+template <class Functor>
+struct is_multi_fidelity<
+    Functor,
+    std::void_t<
+        decltype(std::declval<const Functor&>().levels()),
+        decltype(std::declval<const Functor&>().costs())>>
+    : std::true_type {};
+
+template <class Functor>
+inline constexpr auto is_multi_fidelity_v =
+    is_multi_fidelity<Functor>::value;
+
+/// @brief Objectives with intermediate reports
+///
+/// An objective reports when it takes a trial along with
+/// the input, f(x, trial), see optimization/stopping.hpp.
+template <
+    class Functor,
+    class Input,
+    class Trial,
+    class = void>
+struct is_reporting : std::false_type {};
+
+template <class Functor, class Input, class Trial>
+struct is_reporting<
+    Functor,
+    Input,
+    Trial,
+    std::void_t<decltype(std::declval<Functor&>()(
+        std::declval<const Input&>(),
+        std::declval<Trial&>()))>> : std::true_type {};
+
+template <class Functor, class Input, class Trial>
+inline constexpr auto is_reporting_v =
+    is_reporting<Functor, Input, Trial>::value;
+
+}  // namespace b2o::optimization
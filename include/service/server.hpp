@@ -0,0 +1,567 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "acquisition/expected_improvement_feasible.hpp"
+#include "domain/bounds.hpp"
+#include "gaussian/process.hpp"
+#include "kernel/matern.hpp"
+#include "optimization/lbfgsb.hpp"
+#include "optimization/study.hpp"
+
+namespace b2o::service {
+
+/// @brief Ask/tell server of many studies
+///
+/// Hosts named studies (optimization/study.hpp) behind a
+/// line protocol on a local Unix socket, one request per
+/// line, one reply per request ("ok ..." or "err reason"):
+///
+///   open <study> <lo> <hi> ...   declare (or reopen) a
+///                                study, one finite range
+///                                per dimension (lo == hi
+///                                fixes an unused one)
+///   ask <study>                  ok <ticket> <x> ...
+///                                (err failed once its
+///                                proposals fail)
+///   tell <study> <ticket> <y>    ok, y = nan for a failed
+///                                evaluation (other
+///                                values must be finite,
+///                                |y| <= 1e150)
+///   best <study>                 ok <y> <x> ...
+///   stats                        ok <studies> <resident>
+///                                <bytes>
+///
+/// Studies live in the unit box (their ranges are mapped on
+/// the way in and out) and journal every result to
+/// <directory>/<study>.b2oj (helpers/journal.hpp), their
+/// ranges to <study>.b2ob: reopening a study (after a
+/// restart too) with other ranges fails. Their
+/// acquisitions share the process wide thread pool. The
+/// resident models are accounted by size, O(n^2) each:
+/// past `memory` the least recently used idle studies (no
+/// outstanding asks) are evicted, their journal is the
+/// snapshot they resume from on the next request (studies
+/// whose journal failed to flush stay resident; a journal
+/// that cannot be opened fails the request with
+/// "err journal"). A study
+/// past `study_memory` stops proposing (asks fail), its
+/// outstanding tells are still accepted.
+/// @tparam Dimension Maximum dimension of the studies
+template <std::size_t Dimension>
+class server {
+  using number_t = double;
+  using kernel_t = kernel::matern52<number_t>;
+  using model_t =
+      decltype(gaussian::make_process<Dimension>(
+          std::declval<const kernel_t&>()));
+  using domain_t = domain::bounds<number_t, Dimension>;
+  using study_t = optimization::study<
+      acquisition::expected_improvement_feasible,
+      optimization::lbfgsb,
+      model_t,
+      domain_t>;
+  using input_t = typename study_t::input_t;
+  using limits_t = typename domain_t::config_t;
+
+  static constexpr auto kLength = number_t{0.2};
+  static constexpr auto kLargest = number_t{1e150};
+  static constexpr auto kMemory = std::size_t{256} << 20;
+  static constexpr auto kStudyMemory =
+      std::size_t{64} << 20;
+  static constexpr auto kDepth = std::size_t{2};
+  static constexpr auto kBacklog = 64;
+  static constexpr auto kBuffer = std::size_t{4096};
+
+ public:
+  struct config_t {
+    std::string socket;     ///< Unix socket path
+    std::string directory;  ///< Journals of the studies
+    std::size_t memory{kMemory};  ///< Resident models
+    std::size_t study_memory{kStudyMemory};  ///< Per study
+    std::size_t depth{kDepth};  ///< Proposals kept ready
+  };
+
+  explicit server(config_t config)
+      : config_{std::move(config)} {
+  }
+
+  server(const server&) = delete;
+  auto operator=(const server&) -> server& = delete;
+
+  ~server() {
+    stop();
+  }
+
+  /// @brief Bind the socket (replacing a stale one)
+  /// @return false on errors
+  auto listen() -> bool {
+    auto address = sockaddr_un{};
+    if (config_.socket.size() >= sizeof(address.sun_path)) {
+      return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, config_.socket.c_str());
+    ::unlink(config_.socket.c_str());
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+      return false;
+    }
+    const auto* p = reinterpret_cast<sockaddr*>(&address);
+    if (::bind(fd_, p, sizeof(address)) != 0 ||
+        ::listen(fd_, kBacklog) != 0) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Serve connections (one thread each) until
+  /// stop()
+  auto serve() -> void {
+    while (true) {
+      const auto fd = ::accept(fd_, nullptr, nullptr);
+      if (fd < 0) {
+        break;
+      }
+      const auto lock = std::lock_guard{mutex_};
+      if (stopped_) {
+        ::close(fd);
+        break;
+      }
+      // join the finished connections first, their fd
+      // may be this one
+      for (const auto done : finished_) {
+        threads_[done].join();
+        threads_.erase(done);
+      }
+      finished_.clear();
+      connections_.emplace_back(fd);
+      threads_.emplace(
+          fd, std::thread{[this, fd] { connection(fd); }});
+    }
+  }
+
+  /// @brief Stop serving, close the connections and
+  /// flush the studies (thread safe, idempotent)
+  auto stop() -> void {
+    auto threads = std::map<int, std::thread>{};
+    {
+      const auto lock = std::lock_guard{mutex_};
+      if (stopped_) {
+        return;
+      }
+      stopped_ = true;
+      if (fd_ >= 0) {
+        ::shutdown(fd_, SHUT_RDWR);
+      }
+      for (const auto fd : connections_) {
+        ::shutdown(fd, SHUT_RDWR);
+      }
+      threads = std::move(threads_);
+    }
+    for (auto& [_, thread] : threads) {
+      thread.join();
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+      ::unlink(config_.socket.c_str());
+    }
+    studies_.clear();
+  }
+
+  /// @brief Reply to one request line (the protocol
+  /// without the socket)
+  auto handle(const std::string& line) -> std::string {
+    auto in = std::istringstream{line};
+    auto command = std::string{};
+    auto name = std::string{};
+    in >> command;
+    if (command == "stats") {
+      const auto lock = std::lock_guard{mutex_};
+      return "ok " + std::to_string(studies_.size()) + " " +
+             std::to_string(lru_.size()) + " " +
+             std::to_string(bytes_);
+    }
+    if (!(in >> name) || !valid(name)) {
+      return "err request";
+    }
+    if (command == "open") {
+      return open(name, in);
+    }
+    const auto [entry, study] = acquire(name);
+    if (entry == nullptr) {
+      return "err study";
+    }
+    if (!study) {
+      return "err journal";
+    }
+    auto reply = std::string{"err request"};
+    if (command == "ask") {
+      reply = ask(*entry, *study);
+    } else if (command == "tell") {
+      reply = tell(*study, in);
+    } else if (command == "best") {
+      reply = best(*entry, *study);
+    }
+    account(*entry, *study);
+    return reply;
+  }
+
+ protected:
+  struct entry_t {
+    std::mutex mutex;  ///< Held to load or evict
+    limits_t limits{};
+    std::shared_ptr<study_t> study;  ///< Pinned per request
+    std::size_t bytes{0};
+    typename std::list<entry_t*>::iterator lru;
+  };
+
+  // Model, factor and samples of n inputs
+  static auto estimate(std::size_t n) -> std::size_t {
+    return (2 * n * n + (Dimension + 2) * n) *
+           sizeof(number_t);
+  }
+
+  static auto valid(const std::string& name) -> bool {
+    return std::all_of(
+        std::cbegin(name), std::cend(name), [](char c) {
+          const auto u = static_cast<unsigned char>(c);
+          return std::isalnum(u) || c == '_' || c == '-';
+        });
+  }
+
+  static auto format(number_t value) -> std::string {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+  }
+
+  // A study is declared once per server run, the first
+  // open checks (or saves) the ranges of its journal
+  auto open(const std::string& name, std::istream& in)
+      -> std::string {
+    auto limits = limits_t{};
+    for (auto& [lo, hi] : limits) {
+      if (!(in >> lo >> hi) || !std::isfinite(lo) ||
+          !std::isfinite(hi) || !(lo <= hi)) {
+        return "err bounds";
+      }
+    }
+    const auto lock = std::lock_guard{mutex_};
+    const auto it = studies_.find(name);
+    if (it != std::end(studies_)) {
+      return (it->second->limits == limits) ? "ok"
+                                             : "err bounds";
+    }
+    const auto path = config_.directory + "/" + name;
+    auto saved = limits_t{};
+    switch (read_limits(path + ".b2ob", saved)) {
+      case limits_status::missing:
+        if (!write_limits(path + ".b2ob", limits)) {
+          return "err journal";
+        }
+        break;
+      case limits_status::found:
+        if (saved != limits) {
+          return "err bounds";
+        }
+        break;
+      case limits_status::invalid:
+        return "err bounds";
+    }
+    auto entry = std::make_unique<entry_t>();
+    entry->limits = limits;
+    entry->lru = std::end(lru_);
+    studies_.emplace(name, std::move(entry));
+    return "ok";
+  }
+
+  enum class limits_status { missing, found, invalid };
+
+  // Ranges saved with a journal, one "lo hi" line per
+  // dimension
+  static auto read_limits(
+      const std::string& path, limits_t& limits)
+      -> limits_status {
+    auto* file = std::fopen(path.c_str(), "r");
+    if (file == nullptr) {
+      return (errno == ENOENT) ? limits_status::missing
+                               : limits_status::invalid;
+    }
+    auto status = limits_status::found;
+    for (auto& [lo, hi] : limits) {
+      if (std::fscanf(file, "%lf %lf", &lo, &hi) != 2) {
+        status = limits_status::invalid;
+        break;
+      }
+    }
+    std::fclose(file);
+    return status;
+  }
+
+  // Written to a temporary file first, renamed once synced
+  static auto write_limits(
+      const std::string& path, const limits_t& limits)
+      -> bool {
+    const auto temporary = path + ".tmp";
+    auto* file = std::fopen(temporary.c_str(), "w");
+    if (file == nullptr) {
+      return false;
+    }
+    auto ok = true;
+    for (const auto& [lo, hi] : limits) {
+      ok = ok && std::fprintf(
+                     file,
+                     "%s %s\n",
+                     format(lo).c_str(),
+                     format(hi).c_str()) > 0;
+    }
+    ok = ok && std::fflush(file) == 0 &&
+         ::fsync(::fileno(file)) == 0;
+    ok = (std::fclose(file) == 0) && ok;
+    ok = ok && std::rename(
+                   temporary.c_str(), path.c_str()) == 0;
+    if (!ok) {
+      std::remove(temporary.c_str());
+    }
+    return ok;
+  }
+
+  // Entry of a study and its resident study, pinned (not
+  // evicted) while the request holds it: ask and tell run
+  // without the entry lock, the study is thread safe
+  auto acquire(const std::string& name)
+      -> std::pair<entry_t*, std::shared_ptr<study_t>> {
+    auto* entry = static_cast<entry_t*>(nullptr);
+    {
+      const auto lock = std::lock_guard{mutex_};
+      const auto it = studies_.find(name);
+      if (it == std::end(studies_)) {
+        return {nullptr, nullptr};
+      }
+      entry = it->second.get();
+    }
+    const auto lock = std::lock_guard{entry->mutex};
+    if (!entry->study) {
+      load(name, *entry);
+    }
+    return {entry, entry->study};
+  }
+
+  // Resident study of an entry, none if its journal cannot
+  // be opened
+  auto load(const std::string& name, entry_t& entry)
+      -> void {
+    auto limits = limits_t{};
+    auto start = input_t{};
+    for (std::size_t d = 0; d < Dimension; ++d) {
+      const auto& [lo, hi] = entry.limits[d];
+      const auto width =
+          (lo < hi) ? number_t{1} : number_t{0};
+      limits[d] = {number_t{0}, width};
+      start[d] = width / 2;
+    }
+    const auto path =
+        config_.directory + "/" + name + ".b2oj";
+    const auto kernel = kernel_t{kLength};
+    try {
+      entry.study = std::make_shared<study_t>(
+          gaussian::make_process<Dimension>(kernel),
+          domain_t{limits, start},
+          typename study_t::config_t{},
+          config_.depth,
+          study_t::fantasy::mean,
+          typename study_t::journal_t{path});
+    } catch (const std::system_error&) {
+      entry.study.reset();
+    }
+  }
+
+  auto ask(const entry_t& entry, study_t& study)
+      -> std::string {
+    const auto n = study.size() + study.outstanding() + 1;
+    if (estimate(n) > config_.study_memory) {
+      return "err budget";
+    }
+    // a failed worker (study.hpp) proposes nothing more
+    auto asked = typename study_t::asked_t{};
+    try {
+      asked = study.ask();
+    } catch (const std::exception&) {
+      return "err failed";
+    }
+    const auto& [ticket, u] = asked;
+    auto reply = "ok " + std::to_string(ticket);
+    for (std::size_t d = 0; d < Dimension; ++d) {
+      const auto& [lo, hi] = entry.limits[d];
+      reply += " " + format(lo + u[d] * (hi - lo));
+    }
+    return reply;
+  }
+
+  auto tell(study_t& study, std::istream& in)
+      -> std::string {
+    auto ticket = typename study_t::ticket_t{};
+    auto text = std::string{};
+    if (!(in >> ticket >> text)) {
+      return "err request";
+    }
+    auto* end = static_cast<char*>(nullptr);
+    const auto y = std::strtod(text.c_str(), &end);
+    if (*end != '\0') {
+      return "err request";
+    }
+    // the model squares values (and inf poisons it for
+    // good, through the journal), nan marks a failure
+    if (!std::isnan(y) && !(std::abs(y) <= kLargest)) {
+      return "err value";
+    }
+    return study.tell(ticket, y) ? "ok" : "err ticket";
+  }
+
+  auto best(const entry_t& entry, const study_t& study)
+      -> std::string {
+    const auto [u, y] = study.best();
+    if (!std::isfinite(y)) {
+      return "err empty";
+    }
+    auto reply = "ok " + format(y);
+    for (std::size_t d = 0; d < Dimension; ++d) {
+      const auto& [lo, hi] = entry.limits[d];
+      reply += " " + format(lo + u[d] * (hi - lo));
+    }
+    return reply;
+  }
+
+  // Account the size of a resident entry and evict the
+  // least recently used idle ones past the budget (not
+  // pinned by a request). The evicted studies are destroyed
+  // (their workers joined) after the server lock is
+  // released, their entries stay locked until then so that
+  // none is reloaded first.
+  auto account(entry_t& entry, const study_t& study)
+      -> void {
+    struct evicted_t {
+      std::unique_lock<std::mutex> lock;
+      std::shared_ptr<study_t> study;
+    };
+    const auto bytes = estimate(study.size());
+    auto evicted = std::vector<evicted_t>{};
+    const auto lock = std::lock_guard{mutex_};
+    if (entry.lru != std::end(lru_)) {
+      lru_.erase(entry.lru);
+      bytes_ -= entry.bytes;
+    }
+    lru_.push_front(&entry);
+    entry.lru = std::begin(lru_);
+    entry.bytes = bytes;
+    bytes_ += bytes;
+    auto it = std::end(lru_);
+    while (bytes_ > config_.memory &&
+           it != std::begin(lru_)) {
+      auto* victim = *--it;
+      if (victim == &entry) {
+        continue;
+      }
+      auto guard =
+          std::unique_lock{victim->mutex, std::try_to_lock};
+      if (guard && victim->study.use_count() == 1 &&
+          victim->study->outstanding() == 0 &&
+          victim->study->journaled()) {
+        evicted.push_back(
+            {std::move(guard), std::move(victim->study)});
+        bytes_ -= victim->bytes;
+        victim->bytes = 0;
+        it = lru_.erase(it);
+        victim->lru = std::end(lru_);
+      }
+    }
+  }
+
+  // Requests of one connection, line by line
+  auto connection(int fd) -> void {
+    auto buffer = std::string{};
+    char chunk[kBuffer];
+    while (true) {
+      const auto n = ::read(fd, chunk, sizeof(chunk));
+      if (n <= 0) {
+        break;
+      }
+      buffer.append(chunk, static_cast<std::size_t>(n));
+      auto replies = std::string{};
+      auto begin = std::size_t{0};
+      for (auto end = buffer.find('\n');
+           end != std::string::npos;
+           end = buffer.find('\n', begin)) {
+        const auto line = buffer.substr(begin, end - begin);
+        replies += handle(line) + "\n";
+        begin = end + 1;
+      }
+      buffer.erase(0, begin);
+      if (!write(fd, replies)) {
+        break;
+      }
+    }
+    const auto lock = std::lock_guard{mutex_};
+    connections_.erase(std::remove(
+        std::begin(connections_),
+        std::end(connections_),
+        fd));
+    finished_.emplace_back(fd);
+    ::close(fd);
+  }
+
+  static auto write(int fd, const std::string& text)
+      -> bool {
+    auto* data = text.data();
+    auto size = text.size();
+    while (size > 0) {
+      const auto n = ::send(fd, data, size, MSG_NOSIGNAL);
+      if (n < 0) {
+        return false;
+      }
+      data += n;
+      size -= static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+
+ private:
+  config_t config_;
+  int fd_{-1};
+  std::mutex mutex_;  ///< Studies, LRU and connections
+  std::map<std::string, std::unique_ptr<entry_t>> studies_;
+  std::list<entry_t*> lru_;  ///< Resident, recent first
+  std::size_t bytes_{0};
+  std::vector<int> connections_;
+  std::map<int, std::thread> threads_;  ///< By socket
+  std::vector<int> finished_;  ///< Threads to join
+  bool stopped_{false};
+};
+
+}  // namespace b2o::service
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "solver/tiled_cholesky.hpp"
+
+namespace b2o::math {
+
+// @brief Direct solver policy
+//
+// Keeps the Cholesky factor L of the kernel matrix and the
+// forward solution z = L.inv * y, so that appending a
+// sample only costs one new row of L and one new entry of z:
+//
+//   build(K)           L L.T = K
+//   update(K)          append the last row of K to L
+//   solve(K, y, a)     a = L.T.inv * L.inv * y
+//   quadratic(K, b)    b.T * K.inv * b = dot(v, v) ,
+//                      v = L.inv * b
+//   inverse(K, b)      K.inv * b = L.T.inv * v
+//   log_determinant(K) 2 * sum(log(L_ii))
+//
+// The right hand side y of solve is assumed to extend the
+// one of the previous call since the last build.
+//
+template <
+    class Number,
+    class Factorization = tiled_cholesky<Number>>
+class direct {
+  using Vector = std::vector<Number>;
+  using Matrix = std::vector<Vector>;
+
+ public:
+  explicit direct(
+      const Factorization& factor = Factorization{})
+      : factor_{factor} {
+  }
+
+  template <class MatrixA>
+  auto build(const MatrixA& k, const Number&) -> void {
+    factor_.build(k, l_);
+    z_.clear();
+  }
+
+  template <class MatrixA>
+  auto update(const MatrixA& k, const Number&) -> void {
+    factor_.build(k, l_, l_.size());
+  }
+
+  template <class MatrixA, class VectorY, class VectorX>
+  auto solve(
+      const MatrixA&,    //
+      const VectorY& y,  //
+      VectorX& x) -> void {
+    factor_.forward(l_, y, z_, z_.size());
+    factor_.backward(l_, z_, x);
+  }
+
+  template <class MatrixA, class VectorB>
+  auto quadratic(const MatrixA&, const VectorB& b) const {
+    using Value = typename VectorB::value_type;
+    auto v = std::vector<Value>{};
+    factor_.forward(l_, b, v);
+    auto sum = Value{0};
+    for (const auto& vi : v) {
+      sum = sum + vi * vi;
+    }
+    return sum;
+  }
+
+  template <class MatrixA, class VectorB>
+  auto inverse(const MatrixA&, const VectorB& b) const {
+    using Value = typename VectorB::value_type;
+    auto v = std::vector<Value>{};
+    auto x = std::vector<Value>{};
+    factor_.forward(l_, b, v);
+    factor_.backward(l_, v, x);
+    return x;
+  }
+
+  template <class MatrixA>
+  auto log_determinant(const MatrixA&) const -> Number {
+    auto sum = Number{0};
+    for (std::size_t i = 0; i < l_.size(); ++i) {
+      sum += std::log(l_[i][i]);
+    }
+    return Number{2} * sum;
+  }
+
+  auto size() const -> std::size_t {
+    return l_.size();
+  }
+
+ private:
+  Factorization factor_;
+  Matrix l_;
+  Vector z_;
+};
+
+}  // namespace b2o::math
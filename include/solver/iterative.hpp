@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "dual/number.hpp"
+#include "helpers/thread_pool.hpp"
+#include "solver/cholesky.hpp"
+
+namespace b2o::math {
+
+/// @brief Configuration for the iterative solver
+template <class Number>
+struct iterative_config {
+  using number_t = Number;
+
+  std::size_t iterations{1000};  ///< Maximum CG iterations
+  std::size_t rank{64};          ///< Preconditioner rank
+  std::size_t probes{32};        ///< Log-determinant probes
+  number_t tolerance{1e-6};      ///< Relative residual
+};
+
+// @brief Iterative solver policy
+//
+// Never forms the Cholesky factor of the kernel matrix K.
+// All operations only need matrix-vector products with K:
+//
+// Preconditioner (pivoted Cholesky of rank r):
+//   P = Lr Lr.T + sn.var * I ,
+//   P.inv * v = (v - Lr M.inv Lr.T v) / sn.var ,
+//   M = sn.var * I + Lr.T Lr              (r x r),
+//
+// Solve (preconditioned conjugate gradient):
+//   a = K.inv * y ,
+//   warm started from the previous solution.
+//
+// Inverse (arbitrary right hand side):
+//   x = K.inv * b , PCG from zero.
+//
+// Quadratic form (predictive variance):
+//   b.T * K.inv * b ,
+//   the Gauss quadrature of the Lanczos process hidden in
+//   PCG, evaluated as dot(b, x) with x the PCG solution.
+//
+// Log-determinant (stochastic Lanczos quadrature):
+//   log|K| = log|P| + tr(log(P.inv * K)) ,
+//   tr(.) ~ mean_z |z|^2 * e1.T log(T) e1 ,  z ~ N(0, P),
+//   T the Lanczos tridiagonal rebuilt from PCG coefficients.
+//
+// The log-determinant is a stochastic estimate, its error
+// ~ |log(P.inv * K)|_F / sqrt(probes): below a nat or two
+// while the rank covers the spectrum of the kernel (long
+// length scales, n of a few hundreds), tens of nats past
+// it (n = 512 samples of a radial kernel at 1/12 of the
+// box and noise 1e-3: about 20). Raise the rank first,
+// the probes only reduce it as 1/sqrt.
+//
+// Memory is O(n r) on top of the kernel matrix owned by the
+// model, against the O(n^2) factor of the direct solver.
+//
+template <class Number>
+class iterative {
+  using Vector = std::vector<Number>;
+  using Matrix = std::vector<Vector>;
+
+  static constexpr auto kParallelRows = std::size_t{1024};
+  static constexpr auto kMinEigen =
+      std::numeric_limits<Number>::min();
+
+ public:
+  using number_t = Number;
+  using config_t = iterative_config<Number>;
+
+  explicit iterative(const config_t& config = {})
+      : config_{config} {
+  }
+
+  template <class MatrixA>
+  auto build(const MatrixA& k, const Number& noise)
+      -> void {
+    precondition(k, noise);
+  }
+
+  template <class MatrixA>
+  auto update(const MatrixA& k, const Number& noise)
+      -> void {
+    precondition(k, noise);
+  }
+
+  template <class MatrixA, class VectorY, class VectorX>
+  auto solve(
+      const MatrixA& k,  //
+      const VectorY& y,  //
+      VectorX& x) -> void {
+    x.resize(y.size(), Number{0});
+    conjugate(k, y, x, [](const auto&, const auto&) {});
+  }
+
+  template <class MatrixA, class VectorB>
+  auto quadratic(const MatrixA& k, const VectorB& b) const {
+    return dot(b, inverse(k, b));
+  }
+
+  template <class MatrixA, class VectorB>
+  auto inverse(const MatrixA& k, const VectorB& b) const {
+    using Value = typename VectorB::value_type;
+    auto x = std::vector<Value>(b.size(), Value{0});
+    conjugate(k, b, x, [](const auto&, const auto&) {});
+    return x;
+  }
+
+  template <class MatrixA>
+  auto log_determinant(const MatrixA& k) const -> Number {
+    const auto n = k.size();
+    if (n == 0) {
+      return Number{0};
+    }
+    auto rng = std::mt19937{};
+    auto normal = std::normal_distribution<Number>{};
+    auto trace = Number{0};
+    for (std::size_t s = 0; s < config_.probes; ++s) {
+      // z ~ N(0, P)
+      auto z = Vector(n);
+      for (auto& zi : z) {
+        zi = std::sqrt(noise_) * normal(rng);
+      }
+      for (const auto& col : lr_) {
+        const auto g = normal(rng);
+        for (std::size_t i = 0; i < n; ++i) {
+          z[i] += col[i] * g;
+        }
+      }
+      auto alpha = Vector{};
+      auto beta = Vector{};
+      auto x = Vector(n, Number{0});
+      conjugate(k, z, x, [&](auto a, auto b) {
+        alpha.emplace_back(a);
+        beta.emplace_back(b);
+      });
+      trace += dot(z, apply(z)) * quadrature(alpha, beta);
+    }
+    return log_det_p_ + trace / Number(config_.probes);
+  }
+
+  auto size() const -> std::size_t {
+    return diag_.size();
+  }
+
+ protected:
+  template <class V>
+  static auto magnitude(const V& v) -> Number {
+    if constexpr (dual::is_number_v<V>) {
+      return v.value();
+    } else {
+      return v;
+    }
+  }
+
+  template <class VectorA, class VectorB>
+  static auto dot(const VectorA& a, const VectorB& b) {
+    using Value = typename VectorA::value_type;
+    auto sum = Value{0};
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      sum = sum + a[i] * b[i];
+    }
+    return sum;
+  }
+
+  // y = K * x, rows split across the pool when it pays off
+  template <class MatrixA, class VectorX>
+  static auto multiply(const MatrixA& k, const VectorX& x) {
+    using Value = typename VectorX::value_type;
+    const auto n = x.size();
+    auto y = std::vector<Value>(n, Value{0});
+    const auto row = [&](std::size_t i) {
+      const auto& ki = k[i];
+      auto sum = Value{0};
+      for (std::size_t j = 0; j < n; ++j) {
+        sum = sum + ki[j] * x[j];
+      }
+      y[i] = sum;
+    };
+    if constexpr (std::is_same_v<Value, Number>) {
+      if (n >= kParallelRows) {
+        thread_pool::instance().parallel_for(n, row);
+        return y;
+      }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      row(i);
+    }
+    return y;
+  }
+
+  // Woodbury form of P.inv * v
+  template <class VectorV>
+  auto apply(const VectorV& v) const {
+    using Value = typename VectorV::value_type;
+    const auto n = v.size();
+    const auto r = lr_.size();
+    auto u = std::vector<Value>(r, Value{0});
+    for (std::size_t c = 0; c < r; ++c) {
+      u[c] = dot(v, lr_[c]);
+    }
+    const auto chol = cholesky<Number>{};
+    auto t = std::vector<Value>{};
+    auto w = std::vector<Value>{};
+    chol.forward(m_, u, t);
+    chol.backward(m_, t, w);
+    auto result = std::vector<Value>(v);
+    for (std::size_t c = 0; c < r; ++c) {
+      for (std::size_t i = 0; i < n; ++i) {
+        result[i] = result[i] - lr_[c][i] * w[c];
+      }
+    }
+    for (auto& ri : result) {
+      ri = ri / noise_;
+    }
+    return result;
+  }
+
+  // Preconditioned conjugate gradient on K x = b, reports
+  // the CG coefficients (alpha, beta) of every iteration.
+  template <
+      class MatrixA,
+      class VectorB,
+      class VectorX,
+      class Fn>
+  auto conjugate(
+      const MatrixA& k,  //
+      const VectorB& b,  //
+      VectorX& x,        //
+      Fn report) const -> void {
+    using Value = typename VectorX::value_type;
+    const auto n = b.size();
+    const auto bnorm = std::sqrt(magnitude(dot(b, b)));
+    if (n == 0 || bnorm == Number{0}) {
+      std::fill(std::begin(x), std::end(x), Value{0});
+      return;
+    }
+    auto r = multiply(k, x);
+    for (std::size_t i = 0; i < n; ++i) {
+      r[i] = b[i] - r[i];
+    }
+    auto z = apply(r);
+    auto p = z;
+    auto rz = dot(r, z);
+    const auto limit = config_.tolerance * bnorm;
+    for (std::size_t s = 0; s < config_.iterations; ++s) {
+      if (std::sqrt(magnitude(dot(r, r))) <= limit) {
+        break;
+      }
+      const auto q = multiply(k, p);
+      const auto alpha = rz / dot(p, q);
+      for (std::size_t i = 0; i < n; ++i) {
+        x[i] = x[i] + alpha * p[i];
+        r[i] = r[i] - alpha * q[i];
+      }
+      z = apply(r);
+      const auto rz_next = dot(r, z);
+      const auto beta = rz_next / rz;
+      for (std::size_t i = 0; i < n; ++i) {
+        p[i] = z[i] + beta * p[i];
+      }
+      rz = rz_next;
+      report(magnitude(alpha), magnitude(beta));
+    }
+  }
+
+  // Pivoted Cholesky of K - sn.var * I (rank r) and the
+  // Woodbury capacitance matrix M = sn.var * I + Lr.T Lr
+  template <class MatrixA>
+  auto precondition(const MatrixA& k, const Number& noise)
+      -> void {
+    const auto n = k.size();
+    const auto r = std::min(config_.rank, n);
+    noise_ = noise;
+    diag_.resize(n);
+    auto trace = Number{0};
+    for (std::size_t i = 0; i < n; ++i) {
+      diag_[i] = k[i][i] - noise;
+      trace += diag_[i];
+    }
+    lr_.clear();
+    auto pivots = std::vector<std::size_t>{};
+    for (std::size_t c = 0; c < r; ++c) {
+      const auto it = std::max_element(
+          std::cbegin(diag_), std::cend(diag_));
+      const auto p = std::distance(std::cbegin(diag_), it);
+      if (*it <= config_.tolerance * trace) {
+        break;
+      }
+      const auto pivot = std::sqrt(*it);
+      auto col = Vector(n, Number{0});
+      for (std::size_t i = 0; i < n; ++i) {
+        auto sum = k[i][p];
+        for (const auto& prev : lr_) {
+          sum -= prev[i] * prev[p];
+        }
+        col[i] = sum / pivot;
+      }
+      for (const auto q : pivots) {
+        col[q] = Number{0};
+      }
+      col[p] = pivot;
+      for (std::size_t i = 0; i < n; ++i) {
+        diag_[i] -= col[i] * col[i];
+      }
+      diag_[p] = Number{0};
+      pivots.emplace_back(p);
+      lr_.emplace_back(std::move(col));
+    }
+    auto m = Matrix(lr_.size(), Vector(lr_.size()));
+    for (std::size_t a = 0; a < lr_.size(); ++a) {
+      for (std::size_t b = 0; b < lr_.size(); ++b) {
+        m[a][b] = dot(lr_[a], lr_[b]) + (a == b) * noise;
+      }
+    }
+    cholesky<Number>{}.build(m, m_);
+    // log|P| = (n - r) log(sn.var) + log|M|
+    log_det_p_ = Number(n - lr_.size()) * std::log(noise);
+    for (std::size_t a = 0; a < m_.size(); ++a) {
+      log_det_p_ += Number{2} * std::log(m_[a][a]);
+    }
+  }
+
+  // e1.T log(T) e1 of the Lanczos tridiagonal T rebuilt
+  // from the CG coefficients, eigenvalues by implicit QL
+  static auto quadrature(
+      const Vector& alpha, const Vector& beta) -> Number {
+    const auto m = alpha.size();
+    if (m == 0) {
+      return Number{0};
+    }
+    auto d = Vector(m);
+    auto e = Vector(m, Number{0});
+    for (std::size_t j = 0; j < m; ++j) {
+      d[j] = Number{1} / alpha[j];
+      if (j > 0) {
+        d[j] += beta[j - 1] / alpha[j - 1];
+      }
+      if (j + 1 < m) {
+        e[j] = std::sqrt(beta[j]) / alpha[j];
+      }
+    }
+    auto w = Vector(m, Number{0});
+    w[0] = Number{1};
+    eigen(d, e, w);
+    auto sum = Number{0};
+    for (std::size_t j = 0; j < m; ++j) {
+      const auto theta = std::max(d[j], kMinEigen);
+      sum += w[j] * w[j] * std::log(theta);
+    }
+    return sum;
+  }
+
+  // Implicit QL on a symmetric tridiagonal matrix (diagonal
+  // d, off-diagonal e), tracking only the first row w of the
+  // eigenvector matrix
+  static auto eigen(Vector& d, Vector& e, Vector& w) -> void {
+    const auto n = static_cast<long>(d.size());
+    const auto eps = std::numeric_limits<Number>::epsilon();
+    for (long l = 0; l < n; ++l) {
+      for (std::size_t iter = 0; iter < 64; ++iter) {
+        auto m = l;
+        for (; m < n - 1; ++m) {
+          const auto dd =
+              std::abs(d[m]) + std::abs(d[m + 1]);
+          if (std::abs(e[m]) <= eps * dd) {
+            break;
+          }
+        }
+        if (m == l) {
+          break;
+        }
+        auto g = (d[l + 1] - d[l]) / (Number{2} * e[l]);
+        auto r = std::hypot(g, Number{1});
+        g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+        auto s = Number{1};
+        auto c = Number{1};
+        auto p = Number{0};
+        auto i = m - 1;
+        for (; i >= l; --i) {
+          const auto f = s * e[i];
+          const auto b = c * e[i];
+          r = std::hypot(f, g);
+          e[i + 1] = r;
+          if (r == Number{0}) {
+            d[i + 1] -= p;
+            e[m] = Number{0};
+            break;
+          }
+          s = f / r;
+          c = g / r;
+          g = d[i + 1] - p;
+          r = (d[i] - g) * s + Number{2} * c * b;
+          p = s * r;
+          d[i + 1] = g + p;
+          g = c * r - b;
+          const auto t = w[i + 1];
+          w[i + 1] = s * w[i] + c * t;
+          w[i] = c * w[i] - s * t;
+        }
+        if (r == Number{0} && i >= l) {
+          continue;
+        }
+        d[l] -= p;
+        e[l] = g;
+        e[m] = Number{0};
+      }
+    }
+  }
+
+ private:
+  config_t config_;
+  Number noise_{1};
+  Number log_det_p_{0};
+  Vector diag_;
+  Matrix lr_;
+  Matrix m_;
+};
+
+}  // namespace b2o::math
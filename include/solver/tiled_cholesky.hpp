@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "helpers/thread_pool.hpp"
+#include "solver/cholesky.hpp"
+
+namespace b2o::math {
+
+// @brief Tiled Cholesky decomposition
+//
+// The matrix is split into square tiles of size Tile and the
+// factorization is expressed as a DAG of tile tasks:
+//
+//   POTRF(k)      L_kk = chol(A_kk)
+//   TRSM(i, k)    L_ik = A_ik * L_kk.T.inv        (i > k)
+//   SYRK(i, k)    A_ii = A_ii - L_ik * L_ik.T     (i > k)
+//   GEMM(i, j, k) A_ij = A_ij - L_ik * L_jk.T     (i > j > k)
+//
+// Task (i, j, k) is the k-th update of tile (i, j); updates
+// of the same tile are chained, the remaining edges follow
+// the data flow of the panel tiles. Ready tasks run on a
+// work-stealing pool, so independent trailing updates of
+// consecutive steps overlap.
+//
+// Forward and backward substitutions use the same scheme
+// with one task per (row tile, column tile) pair.
+//
+// Incremental calls (beg > 0), small systems and non-Number
+// right hand sides (e.g. dual numbers) fall back to the
+// sequential cholesky, they are O(n^2) or cheaper anyway.
+//
+template <class Number, std::size_t Tile = 64>
+class tiled_cholesky : public cholesky<Number> {
+  using Base = cholesky<Number>;
+  using Count = std::atomic<std::uint8_t>;
+
+  static_assert(Tile > 0);
+  static constexpr auto kMinTiles = std::size_t{4};
+
+ public:
+  explicit tiled_cholesky(
+      thread_pool& pool = thread_pool::instance())
+      : pool_{&pool} {
+  }
+
+  template <class MatrixA, class MatrixL>
+  auto build(
+      const MatrixA& a,  //
+      MatrixL& l,        //
+      size_t beg = 0) const -> void {
+    const auto n = a.size();
+    if (beg > 0 || tiles(n) < kMinTiles) {
+      Base::build(a, l, beg);
+      return;
+    }
+    l.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      const auto first = std::cbegin(a[i]);
+      l[i].assign(first, first + i + 1);
+    }
+    const auto t = tiles(n);
+    // task (i, j, k) lives at offset[tile(i, j)] + k
+    auto offset = std::vector<size_t>{};
+    offset.reserve(t * (t + 1) / 2 + 1);
+    offset.emplace_back(0);
+    for (size_t i = 0; i < t; ++i) {
+      for (size_t j = 0; j <= i; ++j) {
+        offset.emplace_back(offset.back() + j + 1);
+      }
+    }
+    const auto index = [&](size_t i, size_t j, size_t k) {
+      return offset[i * (i + 1) / 2 + j] + k;
+    };
+    auto deps = std::vector<Count>(offset.back());
+    for (size_t i = 0; i < t; ++i) {
+      for (size_t j = 0; j <= i; ++j) {
+        for (size_t k = 0; k <= j; ++k) {
+          const auto prev = (k > 0) ? 1 : 0;
+          const auto data = (k < j) ? ((i == j) ? 1 : 2)
+                                    : ((i > j) ? 1 : 0);
+          deps[index(i, j, k)].store(prev + data);
+        }
+      }
+    }
+    const auto run = [&](const task& s) {
+      if (s.k < s.j) {
+        update(l, n, s.i, s.j, s.k);
+      } else if (s.i == s.j) {
+        factor(l, n, s.k);
+      } else {
+        solve(l, n, s.i, s.k);
+      }
+    };
+    const auto next = [&](const task& s, auto emit) {
+      const auto ready = [&](size_t i, size_t j, size_t k) {
+        if (deps[index(i, j, k)].fetch_sub(1) == 1) {
+          emit(task{i, j, k});
+        }
+      };
+      if (s.k < s.j) {
+        ready(s.i, s.j, s.k + 1);
+      } else if (s.i == s.j) {
+        for (auto m = s.k + 1; m < t; ++m) {
+          ready(m, s.k, s.k);
+        }
+      } else {
+        for (auto b = s.k + 1; b <= s.i; ++b) {
+          ready(s.i, b, s.k);
+        }
+        for (auto b = s.i + 1; b < t; ++b) {
+          ready(b, s.i, s.k);
+        }
+      }
+    };
+    execute(offset.back(), task{0, 0, 0}, run, next);
+  }
+
+  template <class MatrixL, class VectorB, class VectorY>
+  auto forward(
+      const MatrixL& l,  //
+      const VectorB& b,  //
+      VectorY& y,        //
+      size_t beg = 0) const -> void {
+    using Value = typename VectorY::value_type;
+    if constexpr (!std::is_same_v<Value, Number>) {
+      Base::forward(l, b, y, beg);
+    } else if (beg > 0 || tiles(b.size()) < kMinTiles) {
+      Base::forward(l, b, y, beg);
+    } else {
+      forward_tiled(l, b, y);
+    }
+  }
+
+  template <class MatrixL, class VectorY, class VectorX>
+  auto backward(
+      const MatrixL& l,  //
+      const VectorY& y,  //
+      VectorX& x) const -> void {
+    using Value = typename VectorX::value_type;
+    if constexpr (!std::is_same_v<Value, Number>) {
+      Base::backward(l, y, x);
+    } else if (tiles(y.size()) < kMinTiles) {
+      Base::backward(l, y, x);
+    } else {
+      backward_tiled(l, y, x);
+    }
+  }
+
+ protected:
+  struct task {
+    size_t i;
+    size_t j;
+    size_t k;
+  };
+
+  template <class MatrixL, class VectorB, class VectorY>
+  auto forward_tiled(
+      const MatrixL& l,  //
+      const VectorB& b,  //
+      VectorY& y) const -> void {
+    const auto n = b.size();
+    y.assign(std::cbegin(b), std::cend(b));
+    // task (i, j): j < i  y_i -= L_ij * y_j
+    //              j == i y_i  = L_ii.inv * y_i
+    const auto t = tiles(n);
+    auto deps = std::vector<Count>(t * t);
+    for (size_t i = 0; i < t; ++i) {
+      for (size_t j = 0; j <= i; ++j) {
+        deps[i * t + j].store((j > 0) + (j < i));
+      }
+    }
+    const auto run = [&](const task& s) {
+      const auto [r0, r1] = range(s.i, n);
+      const auto [c0, c1] = range(s.j, n);
+      for (auto r = r0; r < r1; ++r) {
+        auto sum = y[r];
+        for (auto c = c0; c < std::min(c1, r); ++c) {
+          sum -= l[r][c] * y[c];
+        }
+        y[r] = (s.i == s.j) ? sum / l[r][r] : sum;
+      }
+    };
+    const auto next = [&](const task& s, auto emit) {
+      const auto ready = [&](size_t i, size_t j) {
+        if (deps[i * t + j].fetch_sub(1) == 1) {
+          emit(task{i, j, 0});
+        }
+      };
+      if (s.i == s.j) {
+        for (auto i = s.j + 1; i < t; ++i) {
+          ready(i, s.j);
+        }
+      } else {
+        ready(s.i, s.j + 1);
+      }
+    };
+    execute(t * (t + 1) / 2, task{0, 0, 0}, run, next);
+  }
+
+  template <class MatrixL, class VectorY, class VectorX>
+  auto backward_tiled(
+      const MatrixL& l,  //
+      const VectorY& y,  //
+      VectorX& x) const -> void {
+    const auto n = y.size();
+    x.assign(std::cbegin(y), std::cend(y));
+    // task (i, j): j > i  x_i -= L_ji.T * x_j
+    //              j == i x_i  = L_ii.T.inv * x_i
+    const auto t = tiles(n);
+    auto deps = std::vector<Count>(t * t);
+    for (size_t i = 0; i < t; ++i) {
+      for (auto j = i; j < t; ++j) {
+        deps[i * t + j].store((j + 1 < t) + (j > i));
+      }
+    }
+    const auto run = [&](const task& s) {
+      const auto [r0, r1] = range(s.i, n);
+      const auto [c0, c1] = range(s.j, n);
+      for (auto r = r1; r-- > r0;) {
+        auto sum = x[r];
+        for (auto c = std::max(c0, r + 1); c < c1; ++c) {
+          sum -= l[c][r] * x[c];
+        }
+        x[r] = (s.i == s.j) ? sum / l[r][r] : sum;
+      }
+    };
+    const auto next = [&](const task& s, auto emit) {
+      const auto ready = [&](size_t i, size_t j) {
+        if (deps[i * t + j].fetch_sub(1) == 1) {
+          emit(task{i, j, 0});
+        }
+      };
+      if (s.i == s.j) {
+        for (auto i = s.j; i-- > 0;) {
+          ready(i, s.j);
+        }
+      } else {
+        ready(s.i, s.j - 1);
+      }
+    };
+    execute(
+        t * (t + 1) / 2, task{t - 1, t - 1, 0}, run, next);
+  }
+
+  static auto tiles(size_t n) -> size_t {
+    return (n + Tile - 1) / Tile;
+  }
+
+  static auto range(size_t tile, size_t n) {
+    return std::pair{
+        tile * Tile, std::min((tile + 1) * Tile, n)};
+  }
+
+  // POTRF(k): in-place factorization of the diagonal tile
+  template <class MatrixL>
+  static auto factor(MatrixL& l, size_t n, size_t k)
+      -> void {
+    const auto [r0, r1] = range(k, n);
+    for (auto i = r0; i < r1; ++i) {
+      auto& li = l[i];
+      for (auto j = r0; j <= i; ++j) {
+        const auto& lj = l[j];
+        auto sum = li[j];
+        for (auto p = r0; p < j; ++p) {
+          sum -= li[p] * lj[p];
+        }
+        li[j] = (i == j) ? std::sqrt(sum) : sum / lj[j];
+      }
+    }
+  }
+
+  // TRSM(i, k): L_ik = A_ik * L_kk.T.inv
+  template <class MatrixL>
+  static auto solve(
+      MatrixL& l, size_t n, size_t i, size_t k) -> void {
+    const auto [r0, r1] = range(i, n);
+    const auto [c0, c1] = range(k, n);
+    for (auto r = r0; r < r1; ++r) {
+      auto& lr = l[r];
+      for (auto c = c0; c < c1; ++c) {
+        const auto& lc = l[c];
+        auto sum = lr[c];
+        for (auto p = c0; p < c; ++p) {
+          sum -= lr[p] * lc[p];
+        }
+        lr[c] = sum / lc[c];
+      }
+    }
+  }
+
+  // SYRK / GEMM(i, j, k): A_ij = A_ij - L_ik * L_jk.T
+  template <class MatrixL>
+  static auto update(
+      MatrixL& l, size_t n, size_t i, size_t j, size_t k)
+      -> void {
+    const auto [r0, r1] = range(i, n);
+    const auto [c0, c1] = range(j, n);
+    const auto [p0, p1] = range(k, n);
+    for (auto r = r0; r < r1; ++r) {
+      auto& lr = l[r];
+      const auto last = (i == j) ? r + 1 : c1;
+      for (auto c = c0; c < last; ++c) {
+        const auto& lc = l[c];
+        auto sum = Number{0};
+        for (auto p = p0; p < p1; ++p) {
+          sum += lr[p] * lc[p];
+        }
+        lr[c] -= sum;
+      }
+    }
+  }
+
+  // Run a task graph of size tasks from its single root.
+  // next(s, emit) releases the successors of s that became
+  // ready; the caller helps the pool until all tasks ran.
+  template <class Run, class Next>
+  auto execute(
+      size_t size, task root, Run run, Next next) const
+      -> void {
+    struct graph {
+      thread_pool& pool;
+      Run& run;
+      Next& next;
+      std::atomic<size_t> remaining;
+      auto spawn(const task& s) -> void {
+        pool.submit([this, s] {
+          run(s);
+          next(s, [this](const task& r) { spawn(r); });
+          remaining.fetch_sub(1, std::memory_order_release);
+        });
+      }
+    };
+    auto dag = graph{*pool_, run, next, {size}};
+    dag.spawn(root);
+    dag.pool.wait([&dag] {
+      return dag.remaining.load(
+                 std::memory_order_acquire) == 0;
+    });
+  }
+
+ private:
+  thread_pool* pool_;
+};
+
+}  // namespace b2o::math
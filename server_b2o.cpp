@@ -0,0 +1,61 @@
+#include <signal.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "service/server.hpp"
+
+// studies of up to 8 dimensions (fix the unused ones with
+// lo == hi)
+constexpr auto kDimension = std::size_t{8};
+using server_t = b2o::service::server<kDimension>;
+
+// megabytes argument in bytes
+auto megabytes(const char* text) -> std::size_t {
+  return std::strtoull(text, nullptr, 10) << 20;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(
+        stderr,
+        "usage: %s <socket> <directory> [memory MB] "
+        "[study memory MB]\n",
+        argv[0]);
+    return 1;
+  }
+  auto config = server_t::config_t{};
+  config.socket = argv[1];
+  config.directory = argv[2];
+  if (argc > 3) {
+    config.memory = megabytes(argv[3]);
+  }
+  if (argc > 4) {
+    config.study_memory = megabytes(argv[4]);
+  }
+
+  // SIGINT / SIGTERM stop the server (journals flushed)
+  auto signals = sigset_t{};
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  auto server = server_t{config};
+  if (!server.listen()) {
+    std::perror("listen");
+    return 1;
+  }
+  auto waiter = std::thread{[&] {
+    auto signal = 0;
+    sigwait(&signals, &signal);
+    server.stop();
+  }};
+  server.serve();
+  server.stop();
+  pthread_kill(waiter.native_handle(), SIGTERM);
+  waiter.join();
+}
@@ -0,0 +1,111 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include "dual/number.hpp"
+#include "gaussian/distribution.hpp"
+#include "helpers/print.hpp"
+#include "kernel/radial.hpp"
+#include "math/approx.hpp"
+
+// distance in units in the last place
+auto ulp(double a, double b) {
+  const auto order = [](double d) {
+    auto i = std::int64_t{};
+    std::memcpy(&i, &d, sizeof(i));
+    return (i < 0) ? INT64_MIN - i : i;
+  };
+  return std::llabs(order(a) - order(b));
+}
+
+int main() {
+  namespace approx = b2o::math::approx;
+  auto rng = std::mt19937_64{};
+  auto wide = std::uniform_real_distribution{-708., 709.};
+  auto near = std::uniform_real_distribution{-1.0, 1.0};
+  auto tail = std::uniform_real_distribution{-8.0, 8.0};
+  auto failures = 0;
+  const auto check = [&](auto name, auto error, auto max) {
+    b2o::print_number(name, error);
+    if (!(error <= max)) {
+      b2o::print_number("FAILED bound", max);
+      ++failures;
+    }
+  };
+
+  // exp against libm
+  auto exp_ulp = 0ll;
+  for (int i = 0; i < 4000000; ++i) {
+    const auto x = (i % 2) ? wide(rng) : near(rng);
+    const auto error = ulp(approx::exp(x), std::exp(x));
+    exp_ulp = std::max(exp_ulp, error);
+  }
+  check("exp max ulp", exp_ulp, 2ll);
+  check("exp(-800)", approx::exp(-800.0), 0.0);
+  const auto overflow = approx::exp(800.0);
+  check("exp(800) finite", !std::isinf(overflow), false);
+
+  // erf, erfc and the normal cdf against libm
+  auto erf_abs = 0.0;
+  auto erfc_rel = 0.0;
+  auto cdf_abs = 0.0;
+  auto cdf_rel = 0.0;
+  for (int i = 0; i < 4000000; ++i) {
+    const auto x = tail(rng);
+    const auto cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+    const auto c = approx::cdf(x);
+    const auto erf = std::erf(x);
+    const auto erfc = std::erfc(x);
+    const auto erf_err = std::abs(approx::erf(x) - erf);
+    const auto erfc_err = std::abs(approx::erfc(x) - erfc);
+    erf_abs = std::max(erf_abs, erf_err);
+    erfc_rel = std::max(erfc_rel, erfc_err / erfc);
+    cdf_abs = std::max(cdf_abs, std::abs(c - cdf));
+    if (x < 0) {
+      cdf_rel = std::max(cdf_rel, std::abs(c - cdf) / cdf);
+    }
+  }
+  check("erf max abs", erf_abs, 1.2e-7);
+  check("erfc max rel", erfc_rel, 1.2e-7);
+  check("cdf max abs", cdf_abs, 6.0e-8);
+  check("cdf max rel (x < 0)", cdf_rel, 1.2e-7);
+
+  // policies on dual numbers: values and derivatives
+  using fast = b2o::math::fast;
+  using b2o::gaussian::distribution;
+  const auto d_fast = distribution<double, fast>{};
+  const auto d_slow = distribution<double>{};
+  auto dual_err = 0.0;
+  for (int i = 0; i < 10000; ++i) {
+    const auto x = b2o::dual::make_number(tail(rng));
+    const auto a = d_fast.cdf(x);
+    const auto b = d_slow.cdf(x);
+    const auto c = d_fast.pdf(x);
+    const auto d = d_slow.pdf(x);
+    dual_err = std::max(
+        {dual_err,
+         std::abs(a.value() - b.value()),
+         std::abs(a.dvalue(0) - b.dvalue(0)),
+         std::abs(c.value() - d.value()),
+         std::abs(c.dvalue(0) - d.dvalue(0))});
+  }
+  check("distribution dual max abs", dual_err, 1.2e-7);
+
+  // kernel policy
+  using b2o::kernel::radial;
+  const auto k_fast = radial<double, fast>{2.0};
+  const auto k_slow = radial<double>{2.0};
+  auto kernel_rel = 0.0;
+  for (int i = 0; i < 100000; ++i) {
+    const auto x = std::array{tail(rng), tail(rng)};
+    const auto y = std::array{tail(rng), tail(rng)};
+    const auto a = k_fast(x, y);
+    const auto b = k_slow(x, y);
+    kernel_rel = std::max(kernel_rel, std::abs(a - b) / b);
+  }
+  check("radial max rel", kernel_rel, 4.5e-16);
+
+  return failures;
+}
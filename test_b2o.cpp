@@ -1,7 +1,36 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "builder.hpp"
+#include "helpers/cache.hpp"
+#include "helpers/journal.hpp"
 #include "helpers/print.hpp"
+#include "service/server.hpp"
+#include "solver/cholesky.hpp"
+#include "solver/direct.hpp"
+#include "solver/iterative.hpp"
+#include "solver/tiled_cholesky.hpp"
 
 struct branin {
   template <class V>
@@ -21,10 +50,808 @@ struct branin {
   }
 };
 
-int main() {
-  auto optimizer =  //
+auto make_branin() {
+  return b2o::make_optimizer<2>()
+      .kernel_radial(2.0)
+      .domain_bounds(
+          std::array{
+              std::pair{-5.0, 15.0},  //
+              std::pair{-5.0, 15.0}},
+          std::array{0.0, 0.0})
+      .objective(branin{})
+      .build();
+}
+
+auto check(const char* name, bool ok) -> bool {
+  std::printf("%s: %s\n", name, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// Trust regions of run_trust
+struct trust_probe : decltype(make_branin()) {
+  using base_t = decltype(make_branin());
+  using typename base_t::region_t;
+  using base_t::trust_update;
+
+  explicit trust_probe(base_t base)
+      : base_t{std::move(base)} {
+  }
+};
+
+// A new or restarted region (no best yet) centers on its
+// first evaluation, then improvements move it
+auto test_trust_restart() -> bool {
+  constexpr auto inf =
+      std::numeric_limits<double>::infinity();
+  auto probe = trust_probe{make_branin()};
+  auto r = trust_probe::region_t{{0.0, 0.0}, inf};
+  const auto x1 = std::array{1.0, 2.0};
+  const auto x2 = std::array{3.0, 4.0};
+  probe.trust_update(r, x1, 5.0);
+  const auto first = r.center == x1 && r.best == 5.0;
+  probe.trust_update(r, x2, 1.0);
+  const auto second = r.center == x2 && r.best == 1.0;
+  return check("trust restart recenters", first && second);
+}
+
+// Branin throwing on its n-th call
+struct failing {
+  std::shared_ptr<std::atomic<int>> calls;
+  int n;
+
+  template <class V>
+  auto operator()(const V& x) const {
+    if (++*calls == n) {
+      throw std::runtime_error{"failing"};
+    }
+    return branin{}(x);
+  }
+};
+
+// A throwing objective of a batch is rethrown after the
+// other results are ingested
+auto test_batch_error() -> bool {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto optimizer =
+      b2o::make_optimizer<2>()
+          .kernel_radial(2.0)
+          .domain_bounds(
+              std::array{
+                  std::pair{-5.0, 15.0},  //
+                  std::pair{-5.0, 15.0}},
+              std::array{0.0, 0.0})
+          .objective(failing{calls, 9})
+          .build();
+  optimizer.warmup(4);
+  auto thrown = false;
+  try {
+    optimizer.run_batch(4, {100, 0.01, 1e-12});
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  return check(
+      "batch error",
+      thrown && *calls == 9 &&
+          optimizer.model().size() == 8);
+}
+
+auto make_study_builder() {
+  return b2o::make_optimizer<2>()
+      .kernel_radial(2.0)
+      .domain_bounds(
+          std::array{
+              std::pair{-5.0, 15.0},  //
+              std::pair{-5.0, 15.0}},
+          std::array{0.0, 0.0});
+}
+
+// Waits (up to 10 s) until the study ingested n samples
+template <class Study>
+auto ingested(const Study& study, std::size_t n) -> bool {
+  for (int i = 0; i < 10000 && study.size() < n; ++i) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds{1});
+  }
+  return study.size() == n;
+}
+
+// Ask/tell loop on Branin, two inputs in flight told in
+// reverse order, unknown and repeated tickets refused
+auto test_study() -> bool {
+  auto study =
+      make_study_builder().study({100, 0.01, 1e-12});
+  auto ok = true;
+  auto lowest = std::numeric_limits<double>::infinity();
+  auto last = std::size_t{0};
+  for (int step = 0; step < 25; ++step) {
+    const auto [t0, x0] = study.ask();
+    const auto [t1, x1] = study.ask();
+    ok = ok && (step == 0 || t0 > last) && t1 > t0;
+    last = t1;
+    lowest = std::min({lowest, branin{}(x0), branin{}(x1)});
+    ok = ok && study.tell(t1, branin{}(x1)) &&
+         study.tell(t0, branin{}(x0)) &&
+         !study.tell(t0, 0.0) && !study.tell(t1 + 100, 0.0);
+  }
+  return check(
+      "study",
+      ok && study.outstanding() == 0 &&
+          ingested(study, 50) &&
+          study.best().second == lowest);
+}
+
+// Acquisition optimizer failing on every proposal
+template <class Functor, class Number, class Observer>
+struct failing_optimizer {
+  using number_t = Number;
+  using config_t =
+      b2o::optimization::gradient_config<Number>;
+
+  failing_optimizer(const Functor&, const config_t&) {
+  }
+
+  template <class Input>
+  auto maximize(Input&& x) const -> std::decay_t<Input> {
+    throw std::runtime_error{"proposal"};
+  }
+};
+
+// An exception of the worker reaches ask() instead of
+// terminating (the first proposals need no optimizer)
+auto test_study_error() -> bool {
+  using b2o::acquisition::expected_improvement;
+  auto builder = make_study_builder();
+  auto study = std::move(builder).study<
+      expected_improvement,
+      failing_optimizer>({});
+  const auto [ticket, x] = study.ask();
+  study.tell(ticket, branin{}(x));
+  auto thrown = false;
+  for (int i = 0; i < 4 && !thrown; ++i) {
+    try {
+      const auto asked = study.ask();
+      study.tell(asked.first, branin{}(asked.second));
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+  }
+  return check("study error", thrown);
+}
+
+auto make_journaled(const std::string& path) {
+  return b2o::make_optimizer<2>()
+      .kernel_radial(2.0)
+      .domain_bounds(
+          std::array{
+              std::pair{-5.0, 15.0},  //
+              std::pair{-5.0, 15.0}},
+          std::array{0.0, 0.0})
+      .objective(branin{})
+      .journal(path, 1)
+      .build();
+}
+
+auto file_size(const std::string& path) -> long {
+  struct stat st {};
+  return ::stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+// Evaluations appended to a journal resume after a
+// reopen, a torn tail record is dropped, a short file
+// that is not a journal is refused and left untouched
+auto test_journal() -> bool {
+  char directory[] = "/tmp/b2o_journal_XXXXXX";
+  if (::mkdtemp(directory) == nullptr) {
+    return check("journal", false);
+  }
+  const auto path = std::string{directory} + "/a.b2oj";
+  const auto shorter = std::string{directory} + "/b.b2oj";
+  auto before = std::pair<std::array<double, 2>, double>{};
+  auto size = std::size_t{0};
+  {
+    auto optimizer = make_journaled(path);
+    optimizer.warmup(5);
+    optimizer.run(3, {100, 0.01, 1e-12});
+    before = optimizer.best();
+    size = optimizer.model().size();
+  }
+  const auto flushed = file_size(path);
+  if (auto* file = std::fopen(path.c_str(), "ab")) {
+    std::fputs("torn", file);
+    std::fclose(file);
+  }
+  auto ok = file_size(path) == flushed + 4;
+  {
+    auto optimizer = make_journaled(path);
+    ok = ok && optimizer.model().size() == size &&
+         optimizer.best() == before &&
+         file_size(path) == flushed;
+    optimizer.warmup(1);
+  }
+  using journal_t =
+      b2o::journal<std::array<double, 2>, double>;
+  ok = ok && journal_t{path}.recovered().size() == size + 1;
+
+  if (auto* file = std::fopen(shorter.c_str(), "wb")) {
+    std::fputs("b2o", file);
+    std::fclose(file);
+  }
+  auto refused = false;
+  try {
+    journal_t{shorter};
+  } catch (const std::system_error& e) {
+    refused = e.code().value() == EINVAL;
+  }
+  ok = ok && refused && file_size(shorter) == 3;
+  std::remove(path.c_str());
+  std::remove(shorter.c_str());
+  ::rmdir(directory);
+  return check("journal", ok);
+}
+
+auto text(double value) -> std::string {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+// Ask/tell of two studies through the protocol (no
+// socket), the idle one evicted on every request (no
+// memory) and resumed from its journal, then again after a
+// restart
+auto test_server() -> bool {
+  using server_t = b2o::service::server<2>;
+  char directory[] = "/tmp/b2o_server_XXXXXX";
+  if (::mkdtemp(directory) == nullptr) {
+    return check("server", false);
+  }
+  auto config = server_t::config_t{};
+  config.directory = directory;
+  config.memory = 1;
+  const auto ask = [](server_t& server, const char* name) {
+    auto reply = std::istringstream{
+        server.handle(std::string{"ask "} + name)};
+    auto status = std::string{};
+    auto ticket = std::string{};
+    auto x = std::array<double, 2>{};
+    reply >> status >> ticket >> x[0] >> x[1];
+    return std::pair{status == "ok" ? ticket : "", x};
+  };
+  auto ok = true;
+  auto lowest = std::numeric_limits<double>::infinity();
+  auto resident = std::string{};
+  {
+    auto server = server_t{config};
+    ok = server.handle("open a -5 15 -5 15") == "ok" &&
+         server.handle("open b 0 1 0 1") == "ok" &&
+         server.handle("open a -5 15 -5 15") == "ok" &&
+         server.handle("open a 0 1 0 1") == "err bounds" &&
+         server.handle("open c -inf inf 0 1") ==
+             "err bounds";
+    for (int i = 0; i < 12; ++i) {
+      for (const auto* name : {"a", "b"}) {
+        const auto [ticket, x] = ask(server, name);
+        const auto y = branin{}(x);
+        lowest = (*name == 'a') ? std::min(lowest, y)
+                                : lowest;
+        ok = ok && !ticket.empty() &&
+             server.handle(
+                 std::string{"tell "} + name + " " +
+                 ticket + " " + text(y)) == "ok";
+      }
+    }
+    const auto [ticket, x] = ask(server, "a");
+    ok = ok &&
+         server.handle("tell a " + ticket + " inf") ==
+             "err value" &&
+         server.handle("tell a 999 1") == "err ticket" &&
+         server.handle("tell a " + ticket + " nan") ==
+             "ok" &&
+         server.handle("tell a " + ticket + " 1") ==
+             "err ticket" &&
+         server.handle("ask z") == "err study";
+    resident = server.handle("stats");
+  }
+  auto best = std::string{};
+  {
+    auto server = server_t{config};
+    ok = ok && server.handle("best a") == "err study" &&
+         server.handle("open a 0 1 0 1") == "err bounds" &&
+         server.handle("open a -5 15 -5 15") == "ok";
+    best = server.handle("best a");
+  }
+  for (const auto* file :
+       {"a.b2oj", "a.b2ob", "b.b2oj", "b.b2ob"}) {
+    const auto path = std::string{directory} + "/" + file;
+    std::remove(path.c_str());
+  }
+  ::rmdir(directory);
+  return check(
+      "server",
+      ok && resident.rfind("ok 2 1 ", 0) == 0 &&
+          best.rfind("ok " + text(lowest) + " ", 0) == 0);
+}
+
+// Cells of inputs far past the int64 range of the grid
+// (tiny tolerance, large |x|) still find their samples
+auto test_cache_range() -> bool {
+  using input_t = std::array<double, 2>;
+  auto cache = b2o::cache<input_t, double>{1e-300};
+  const auto x = input_t{1e10, -1e300};
+  cache.insert(x, 1.0);
+  cache.insert({1e10, 1e300}, 2.0);
+  const auto* same = cache.find(x);
+  const auto* other = cache.find({-1e10, -1e300});
+  return check(
+      "cache range",
+      same != nullptr && same->second == 1.0 &&
+          other == nullptr);
+}
+
+using matrix_t = std::vector<std::vector<double>>;
+
+// Kernel matrix (radial, unit length scale) of n random
+// inputs of [-3, 3]^2 and a right hand side
+auto kernel_system(std::size_t n, double noise)
+    -> std::pair<matrix_t, std::vector<double>> {
+  auto rng = std::mt19937{7};
+  auto u = std::uniform_real_distribution<double>{-3, 3};
+  auto x = std::vector<std::array<double, 2>>(n);
+  auto y = std::vector<double>(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = {u(rng), u(rng)};
+    y[i] = std::sin(x[i][0]) * std::cos(x[i][1]);
+  }
+  auto k = matrix_t(n, std::vector<double>(n));
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      const auto d0 = x[i][0] - x[j][0];
+      const auto d1 = x[i][1] - x[j][1];
+      k[i][j] = std::exp(-(d0 * d0 + d1 * d1) / 2) +
+                ((i == j) ? noise : 0.0);
+    }
+  }
+  return {std::move(k), std::move(y)};
+}
+
+template <class A, class B>
+auto max_difference(const A& a, const B& b) -> double {
+  auto result = 0.0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    result = std::max(result, std::abs(a[i] - b[i]));
+  }
+  return result;
+}
+
+// Bowl of minimum at (1, 2)
+struct bowl {
+  template <class V>
+  auto operator()(const V& x) const {
+    const auto d0 = x[0] - 1;
+    const auto d1 = x[1] - 2;
+    return d0 * d0 + d1 * d1;
+  }
+};
+
+auto make_bowl(unsigned seed) {
+  auto domain = b2o::domain::bounds<double, 2>{
+      {std::pair{-1.0, 3.0}, std::pair{0.0, 4.0}},
+      {0.0, 0.0}};
+  domain.seed(seed);
+  return b2o::make_optimizer<2>()
+      .kernel_radial(2.0)
+      .domain(domain)
+      .objective(bowl{})
+      .build();
+}
+
+struct pending_probe : decltype(make_bowl(0)) {
+  using base_t = decltype(make_bowl(0));
+  using typename base_t::fantasy;
+  using base_t::fantasize;
+
+  explicit pending_probe(base_t base)
+      : base_t{std::move(base)} {
+  }
+};
+
+// A pending input below the incumbent (lowest posterior
+// mean) is believed to return its mean: the queued
+// proposal is no improvement there and moves away
+auto test_pending_believed() -> bool {
+  auto repeats = 0;
+  for (unsigned seed = 0; seed < 40; ++seed) {
+    auto probe = pending_probe{make_bowl(seed)};
+    probe.warmup(30);
+    auto x = std::array<double, 2>{};
+    auto lowest = std::numeric_limits<double>::infinity();
+    for (int i = 0; i <= 100; ++i) {
+      for (int j = 0; j <= 100; ++j) {
+        const auto c = std::array{-1 + 0.04 * i, 0.04 * j};
+        const auto mean =
+            std::get<0>(probe.model().predict(c));
+        if (mean < lowest) {
+          lowest = mean;
+          x = c;
+        }
+      }
+    }
+    const auto next = probe.fantasize(
+        {x}, {}, pending_probe::fantasy::mean);
+    repeats += max_difference(next, x) < 1e-2;
+  }
+  return check("pending believed", repeats == 0);
+}
+
+// Trust region steps are reproducible from the seed of the
+// domain (boxes draw from its stream)
+auto test_trust_seeded() -> bool {
+  auto run = [] {
+    auto optimizer = make_bowl(42);
+    optimizer.warmup(5);
+    optimizer.run_trust(15, {}, 2);
+    return optimizer.best();
+  };
+  return check("trust seeded", run() == run());
+}
+
+// Branin counting its calls
+struct counted {
+  std::shared_ptr<int> calls;
+
+  template <class V>
+  auto operator()(const V& x) const {
+    ++*calls;
+    return branin{}(x);
+  }
+};
+
+// Multi-fidelity warmup draws mostly the cheap level (1 /
+// cost), the best stays at the target, the seed of the
+// domain carries over
+auto test_fidelity_warmup() -> bool {
+  using b2o::optimization::fidelity;
+  auto cheap = std::make_shared<int>(0);
+  auto target = std::make_shared<int>(0);
+  auto run = [&] {
+    auto domain = b2o::domain::bounds<double, 3>{
+        {std::pair{-5.0, 15.0},
+         std::pair{-5.0, 15.0},
+         std::pair{0.0, 1.0}},
+        {0.0, 0.0, 1.0}};
+    domain.seed(7u);
+    auto optimizer =
+        b2o::make_optimizer<3>()
+            .kernel_radial(2.0)
+            .domain(domain)
+            .fidelities(
+                fidelity{0.5, 1.0, counted{cheap}},
+                fidelity{1.0, 20.0, counted{target}})
+            .build();
+    optimizer.warmup(40);
+    return optimizer.best();
+  };
+  const auto first = run();
+  const auto calls = std::pair{*cheap, *target};
+  const auto second = run();
+  return check(
+      "fidelity warmup",
+      first == second && first.first[2] == 1.0 &&
+          calls.first > 3 * calls.second);
+}
+
+// Curves getting worse at every step, a misleading value
+// once stopped
+struct curves {
+  std::shared_ptr<std::vector<std::array<double, 2>>> cut;
+
+  template <class V, class Trial>
+  auto operator()(const V& x, Trial& trial) const {
+    const auto y = branin{}(x);
+    for (int s = 1; s <= 8; ++s) {
+      if (!trial.report(y + s)) {
+        cut->emplace_back(x);
+        return -1000.0;
+      }
+    }
+    return y;
+  }
+};
+
+// Stopped evaluations never become the best and enter the
+// model as noisy (low-fidelity) samples
+auto test_stopped_samples() -> bool {
+  auto cut = std::make_shared<
+      std::vector<std::array<double, 2>>>();
+  auto optimizer =
+      b2o::make_optimizer<2>()
+          .kernel_radial(2.0)
+          .domain_bounds(
+              std::array{
+                  std::pair{-5.0, 15.0},  //
+                  std::pair{-5.0, 15.0}},
+              std::array{0.0, 0.0})
+          .objective(curves{cut})
+          .build();
+  optimizer.early_stopping(1, 5);
+  optimizer.warmup(30);
+  auto noisy = !cut->empty();
+  for (const auto& x : *cut) {
+    const auto mean =
+        std::get<0>(optimizer.model().predict(x));
+    noisy = noisy && mean > -900.0;
+  }
+  return check(
+      "stopped samples",
+      optimizer.stopped() == cut->size() && noisy &&
+          optimizer.best().second > -1000.0);
+}
+
+// Tiled factor and substitutions (n past 4 tiles of 64,
+// with a partial last tile) against the sequential ones
+auto test_tiled_cholesky() -> bool {
+  const auto [k, y] = kernel_system(300, 1e-2);
+  const auto sequential = b2o::math::cholesky<double>{};
+  const auto tiled = b2o::math::tiled_cholesky<double>{};
+  auto l0 = matrix_t{};
+  auto l1 = matrix_t{};
+  sequential.build(k, l0);
+  tiled.build(k, l1);
+  auto factor = 0.0;
+  for (std::size_t i = 0; i < k.size(); ++i) {
+    factor = std::max(factor, max_difference(l0[i], l1[i]));
+  }
+  auto z0 = std::vector<double>{};
+  auto z1 = std::vector<double>{};
+  auto a0 = std::vector<double>{};
+  auto a1 = std::vector<double>{};
+  sequential.forward(l0, y, z0);
+  sequential.backward(l0, z0, a0);
+  tiled.forward(l1, y, z1);
+  tiled.backward(l1, z1, a1);
+  return check(
+      "tiled cholesky",
+      factor < 1e-10 && max_difference(z0, z1) < 1e-10 &&
+          max_difference(a0, a1) < 1e-10);
+}
+
+// Conjugate gradient solves and the stochastic
+// log-determinant (default probes and rank) against the
+// direct solver
+auto test_iterative() -> bool {
+  constexpr auto noise = 1e-2;
+  const auto [k, y] = kernel_system(256, noise);
+  auto direct = b2o::math::direct<double>{};
+  auto iterative = b2o::math::iterative<double>{};
+  direct.build(k, noise);
+  iterative.build(k, noise);
+  auto a0 = std::vector<double>{};
+  auto a1 = std::vector<double>{};
+  direct.solve(k, y, a0);
+  iterative.solve(k, y, a1);
+  const auto zero = std::vector<double>(a0.size());
+  const auto solve = max_difference(a0, a1) /
+                     max_difference(a0, zero);
+  const auto q0 = direct.quadratic(k, y);
+  const auto q1 = iterative.quadratic(k, y);
+  const auto det = std::abs(
+      direct.log_determinant(k) -
+      iterative.log_determinant(k));
+  return check(
+      "iterative solver",
+      solve < 1e-3 && std::abs(q0 - q1) < 1e-6 * q0 &&
+          det < 1.0);
+}
+
+// Bound constrained quadratic whose minimum lies on the
+// upper bound of x0: the projected iterate reaches it
+auto test_lbfgsb_bound() -> bool {
+  const auto tilted = [](const auto& x) {
+    const auto a = x[0] - 3.0;
+    const auto b = x[1] - 0.5;
+    return a * a + b * b + 0.5 * x[0] * x[1];
+  };
+  using lbfgsb_t = b2o::optimization::
+      lbfgsb<decltype(tilted), double>;
+  const auto limits = std::array{
+      std::pair{-1.0, 2.0},  //
+      std::pair{-1.0, 1.0}};
+  const auto optimizer =
+      lbfgsb_t{tilted, lbfgsb_t::config_t{}, limits};
+  const auto x = optimizer.minimize(std::array{0.0, 0.0});
+  return check(
+      "lbfgsb bound",
+      x[0] == 2.0 && std::abs(x[1]) < 1e-6);
+}
+
+// CMA-ES converges on a shifted sphere, a fixed seed
+// reproduces the run
+auto test_cmaes() -> bool {
+  static constexpr auto center =
+      std::array{1.0, -2.0, 0.5, 3.0};
+  const auto sphere = [](const auto& x) {
+    auto sum = 0.0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      sum += (x[i] - center[i]) * (x[i] - center[i]);
+    }
+    return sum;
+  };
+  using cmaes_t = b2o::optimization::
+      cmaes<decltype(sphere), double>;
+  auto config = cmaes_t::config_t{};
+  config.generations = 300;
+  config.seed = 7;
+  const auto limits = std::array{
+      std::pair{-5.0, 5.0},
+      std::pair{-5.0, 5.0},
+      std::pair{-5.0, 5.0},
+      std::pair{-5.0, 5.0}};
+  const auto run = [&] {
+    const auto optimizer = cmaes_t{sphere, config, limits};
+    return optimizer.minimize(std::array<double, 4>{});
+  };
+  const auto x = run();
+  return check(
+      "cmaes", sphere(x) < 1e-8 && run() == x);
+}
+
+// Hashed embedding: projecting a lifted point gives it
+// back, lifted points stay in the box, a fixed seed gives
+// the same hash (another seed another one)
+auto test_embedding() -> bool {
+  constexpr auto n = std::size_t{50};
+  using embedding_t = b2o::domain::embedding<double, n, 4>;
+  auto config = embedding_t::config_t{};
+  for (std::size_t i = 0; i < n; ++i) {
+    config[i] = {-double(i), 1.0 + 0.5 * double(i)};
+  }
+  const auto e = embedding_t{config, 11};
+  const auto same = embedding_t{config, 11};
+  const auto other = embedding_t{config, 12};
+  auto rng = std::mt19937{9};
+  auto unit = std::uniform_real_distribution{-1.0, 1.0};
+  auto ok = true;
+  auto differs = false;
+  for (int k = 0; k < 100; ++k) {
+    auto z = embedding_t::input_t{};
+    for (auto& zj : z) {
+      zj = unit(rng);
+    }
+    const auto x = e.lift(z);
+    const auto back = e.project(x);
+    for (std::size_t j = 0; j < z.size(); ++j) {
+      ok = ok && std::abs(back[j] - z[j]) < 1e-12;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto& [lo, hi] = config[i];
+      ok = ok && lo <= x[i] && x[i] <= hi;
+    }
+    ok = ok && same.lift(z) == x;
+    differs = differs || other.lift(z) != x;
+  }
+  return check("embedding", ok && differs);
+}
+
+// Branin, infeasible beyond the half-space x0 + x1 <= 10
+struct half_branin {
+  auto operator()(const std::array<double, 2>& x) const
+      -> std::optional<double> {
+    if (x[0] + x[1] > 10.0) {
+      return std::nullopt;
+    }
+    return branin{}(x);
+  }
+};
+
+// The feasibility classifier separates the half-spaces
+// (mean probability over a grid away from the boundary),
+// the best sample is feasible
+auto test_feasibility() -> bool {
+  using b2o::acquisition::expected_improvement_feasible;
+  auto domain = b2o::domain::bounds<double, 2>{
+      {std::pair{-5.0, 15.0}, std::pair{-5.0, 15.0}},
+      {0.0, 0.0}};
+  domain.seed(1);
+  auto optimizer =
       b2o::make_optimizer<2>()
           .kernel_radial(2.0)
+          .domain(domain)
+          .objective(half_branin{})
+          .build<expected_improvement_feasible>();
+  optimizer.warmup(30);
+  optimizer.run(10, {100, 0.01, 1e-12});
+  const auto& classifier = optimizer.feasibility();
+  auto sums = std::array<double, 2>{};
+  auto counts = std::array<int, 2>{};
+  for (int i = -5; i <= 15; ++i) {
+    for (int j = -5; j <= 15; ++j) {
+      if (std::abs(i + j - 10) < 3) {
+        continue;
+      }
+      const auto side = (i + j < 10) ? 0 : 1;
+      const auto x = std::array{double(i), double(j)};
+      sums[side] += classifier.probability(x);
+      ++counts[side];
+    }
+  }
+  const auto feasible = sums[0] / counts[0];
+  const auto infeasible = sums[1] / counts[1];
+  const auto& [x, y] = optimizer.best();
+  return check(
+      "feasibility",
+      feasible > 0.7 && infeasible < 0.3 &&
+          x[0] + x[1] <= 10.0 && std::isfinite(y));
+}
+
+// Thompson sample paths: their mean over many seeds is the
+// posterior mean, a fixed seed draws the same path
+auto test_sample_path() -> bool {
+  auto model = b2o::gaussian::make_process<2>(
+      b2o::kernel::radial{1.0}, 0.1);
+  auto rng = std::mt19937{3};
+  auto unit = std::uniform_real_distribution{0.0, 3.0};
+  for (int i = 0; i < 12; ++i) {
+    const auto x = std::array{unit(rng), unit(rng)};
+    model.emplace(x, std::sin(x[0]) * std::cos(x[1]));
+  }
+  constexpr auto seeds = 2000;
+  const auto points = std::array{
+      std::array{0.5, 0.5},
+      std::array{1.5, 2.0},
+      std::array{2.5, 1.0}};
+  auto sums = std::array<double, 3>{};
+  for (int seed = 0; seed < seeds; ++seed) {
+    auto draw = std::mt19937_64(seed);
+    const auto path = model.sample(draw);
+    for (std::size_t p = 0; p < points.size(); ++p) {
+      sums[p] += path(points[p]);
+    }
+  }
+  auto ok = true;
+  for (std::size_t p = 0; p < points.size(); ++p) {
+    const auto [mean, variance] = model.predict(points[p]);
+    const auto error = std::sqrt((variance + 0.01) / seeds);
+    ok = ok && std::abs(sums[p] / seeds - mean) < 5 * error;
+  }
+  auto first = std::mt19937_64{42};
+  auto second = std::mt19937_64{42};
+  const auto a = model.sample(first);
+  const auto b = model.sample(second);
+  for (const auto& x : points) {
+    ok = ok && a(x) == b(x);
+  }
+  return check("sample path", ok);
+}
+
+// Solver policy chosen through make_process and the
+// builder: both solvers agree on the posterior
+auto test_solver_policy() -> bool {
+  const auto kernel = b2o::kernel::radial{2.0};
+  auto direct =
+      b2o::gaussian::make_process<2>(kernel, 0.1);
+  auto iterative = b2o::gaussian::
+      make_process<2, b2o::math::iterative>(kernel, 0.1);
+  auto rng = std::mt19937{5};
+  auto unit = std::uniform_real_distribution{-5.0, 15.0};
+  for (int i = 0; i < 40; ++i) {
+    const auto x = std::array{unit(rng), unit(rng)};
+    direct.emplace(x, branin{}(x));
+    iterative.emplace(x, branin{}(x));
+  }
+  auto ok = true;
+  for (int i = 0; i < 10; ++i) {
+    const auto x = std::array{unit(rng), unit(rng)};
+    const auto [m0, v0] = direct.predict(x);
+    const auto [m1, v1] = iterative.predict(x);
+    ok = ok &&
+         std::abs(m0 - m1) < 1e-3 * (1 + std::abs(m0)) &&
+         std::abs(v0 - v1) < 1e-3;
+  }
+
+  auto optimizer =
+      b2o::make_optimizer<2>()
+          .kernel_radial(2.0)
+          .solver<b2o::math::iterative>()
           .domain_bounds(
               std::array{
                   std::pair{-5.0, 15.0},  //
@@ -32,6 +859,45 @@ int main() {
               std::array{0.0, 0.0})
           .objective(branin{})
           .build();
+  using model_t =
+      std::decay_t<decltype(optimizer.model())>;
+  static_assert(std::is_same_v<
+                model_t,
+                b2o::gaussian::process<
+                    b2o::kernel::radial<double>,
+                    double,
+                    2,
+                    b2o::math::iterative<double>>>);
+  optimizer.warmup(10);
+  optimizer.run(5, {100, 0.01, 1e-12});
+  return check(
+      "solver policy",
+      ok && optimizer.model().size() == 1 + 10 + 5 &&
+          std::isfinite(optimizer.best().second));
+}
+
+int main() {
+  auto ok = test_trust_restart();
+  ok = test_tiled_cholesky() && ok;
+  ok = test_iterative() && ok;
+  ok = test_solver_policy() && ok;
+  ok = test_sample_path() && ok;
+  ok = test_lbfgsb_bound() && ok;
+  ok = test_cmaes() && ok;
+  ok = test_embedding() && ok;
+  ok = test_feasibility() && ok;
+  ok = test_pending_believed() && ok;
+  ok = test_trust_seeded() && ok;
+  ok = test_fidelity_warmup() && ok;
+  ok = test_stopped_samples() && ok;
+  ok = test_cache_range() && ok;
+  ok = test_batch_error() && ok;
+  ok = test_journal() && ok;
+  ok = test_study() && ok;
+  ok = test_study_error() && ok;
+  ok = test_server() && ok;
+
+  auto optimizer = make_branin();
 
   // Warmup phas e
   optimizer.warmup(30);
@@ -48,4 +914,5 @@ int main() {
   auto [x_best, y_best] = optimizer.best();
   b2o::print_vector("x_best", x_best);
   b2o::print_number("y_best", y_best);
+  return ok ? 0 : 1;
 }